@@ -8,6 +8,8 @@
 #include <string>
 #include <vector>
 
+class SymbolEntry;
+
 class FunctionInvocationNode final : public ExpressionNode {
   public:
     using ExprNodes = std::vector<std::unique_ptr<ExpressionNode>>;
@@ -15,6 +17,8 @@ class FunctionInvocationNode final : public ExpressionNode {
   private:
     std::string m_name;
     ExprNodes m_args;
+    /// @brief The function invoked, bound once by `NameResolver`.
+    const SymbolEntry *m_symbol_entry = nullptr;
 
   public:
     ~FunctionInvocationNode() = default;
@@ -27,6 +31,10 @@ class FunctionInvocationNode final : public ExpressionNode {
 
     const ExprNodes &getArguments() const { return m_args; }
 
+    /// @return `nullptr` until the names are resolved.
+    const SymbolEntry *getSymbolEntry() const { return m_symbol_entry; }
+    void setSymbolEntry(const SymbolEntry *p_entry) { m_symbol_entry = p_entry; }
+
     void accept(AstNodeVisitor &p_visitor) override { p_visitor.visit(*this); }
     void visitChildNodes(AstNodeVisitor &p_visitor) override;
 };
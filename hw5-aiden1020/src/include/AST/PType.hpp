@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,8 +27,9 @@ class PType {
   private:
     PrimitiveTypeEnum m_type;
     std::vector<uint64_t> m_dimensions;
+    /// @brief Built once, even if back ends on several threads ask for it.
     mutable std::string m_type_string;
-    mutable bool m_type_string_is_valid = false;
+    mutable std::once_flag m_type_string_once;
 
   public:
     ~PType() = default;
@@ -8,6 +8,8 @@
 #include <string>
 #include <vector>
 
+class SymbolEntry;
+
 class VariableReferenceNode final : public ExpressionNode {
   public:
     using ExprNodes = std::vector<std::unique_ptr<ExpressionNode>>;
@@ -15,6 +17,9 @@ class VariableReferenceNode final : public ExpressionNode {
   private:
     std::string m_name;
     ExprNodes m_indices;
+    /// @brief The symbol the name refers to, bound once by `NameResolver` so
+    /// that the passes after it need not look the name up again.
+    const SymbolEntry *m_symbol_entry = nullptr;
 
   public:
     ~VariableReferenceNode() = default;
@@ -35,6 +40,10 @@ class VariableReferenceNode final : public ExpressionNode {
 
     const ExprNodes &getIndices() const { return m_indices; }
 
+    /// @return `nullptr` until the names are resolved.
+    const SymbolEntry *getSymbolEntry() const { return m_symbol_entry; }
+    void setSymbolEntry(const SymbolEntry *p_entry) { m_symbol_entry = p_entry; }
+
     void accept(AstNodeVisitor &p_visitor) override { p_visitor.visit(*this); }
     void visitChildNodes(AstNodeVisitor &p_visitor) override;
 };
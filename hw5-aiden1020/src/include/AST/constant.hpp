@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <mutex>
 
 class Constant
 {
@@ -20,8 +21,9 @@ public:
 private:
   PTypeSharedPtr m_type;
   ConstantValue m_value;
+  /// @brief Built once, even if back ends on several threads ask for it.
   mutable std::string m_constant_value_string;
-  mutable bool m_constant_value_string_is_valid = false;
+  mutable std::once_flag m_constant_value_string_once;
 
 public:
   ~Constant()
@@ -40,6 +42,7 @@ public:
   const char *getConstantValueCString() const;
 
   decltype(m_value.integer) integer() const { return m_value.integer; }
+  decltype(m_value.real) real() const { return m_value.real; }
   decltype(m_value.boolean) boolean() const { return m_value.boolean; }
 };
 
@@ -42,6 +42,8 @@ public:
   const DeclNodes &getParameters() const { return m_parameters; }
 
   const PType *getTypePtr() const { return m_ret_type.get(); }
+  /// @return `nullptr` if this is only a declaration.
+  const CompoundStatementNode *getBody() const { return m_body.get(); }
 
   void accept(AstNodeVisitor &p_visitor) override { p_visitor.visit(*this); }
   void visitChildNodes(AstNodeVisitor &p_visitor) override;
@@ -29,6 +29,12 @@ class VariableNode final : public AstNode {
 
     const PType *getTypePtr() const { return m_type.get(); }
 
+    /// @return `nullptr` if this is not a constant; the node is shared by the
+    /// variables of the same declaration.
+    const ConstantValueNode *getConstantValueNodePtr() const {
+        return m_constant_value_node_ptr.get();
+    }
+
     const Constant *getConstantPtr() const {
         if (!m_constant_value_node_ptr) {
             return nullptr;
@@ -1,37 +1,127 @@
 #ifndef CODEGEN_CODE_GENERATOR_H
 #define CODEGEN_CODE_GENERATOR_H
 
+#include "AST/operator.hpp"
+#include "codegen/DeadStoreAnalyzer.hpp"
+#include "codegen/FunctionCache.hpp"
+#include "codegen/InlineAnalyzer.hpp"
 #include "sema/SemanticAnalyzer.hpp"
 #include "sema/SymbolTable.hpp"
 #include "visitor/AstNodeVisitor.hpp"
 
+#include <cstdint>
 #include <cstdio>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 class CodeGenerator final : public AstNodeVisitor
 {
 private:
+  /// @brief The scopes of the node being emitted, for its declarations; the
+  /// references carry the entry they are bound to.
   SymbolManager m_symbol_manager;
   std::string m_source_file_path;
-  std::unordered_map<SemanticAnalyzer::AstNodeAddr,
-                     SymbolManager::Table>
+  /// @brief Frozen by the semantic analysis and possibly shared with other
+  /// code generators running at the same time; only looked up.
+  const std::unordered_map<SemanticAnalyzer::AstNodeAddr,
+                           SymbolManager::Table>
       m_symbol_table_of_scoping_nodes;
+  /// @brief The frame offset of each local symbol, kept here rather than in
+  /// the shared symbol entries.
+  std::unordered_map<const SymbolEntry *, int> m_frame_offsets;
   /// NOTE: `FILE` cannot be simply deleted by `delete`, so we need a custom deleter.
   std::unique_ptr<FILE, decltype(&fclose)> m_output_file{nullptr, &fclose};
   int m_current_offset = -8;
+  /// @brief The body of the current function is buffered in memory so that the
+  /// prologue can allocate a frame that fits every local and temporary slot.
+  std::unique_ptr<FILE, decltype(&fclose)> m_function_output_file{nullptr, &fclose};
+  char *m_function_body = nullptr;
+  size_t m_function_body_size = 0;
+  /// @brief Whether the current function makes calls and thus uses the
+  /// callee-saved s1 to restore sp after each of them.
+  bool m_saves_s1 = false;
+
+  /// @brief Loop-invariant expressions and global addresses computed in the
+  /// preheader of an enclosing loop, mapped to the frame slot holding them.
+  /// Common subexpressions of the current basic blocks are also reloaded from
+  /// `m_hoisted_expr_offsets`.
+  std::unordered_map<const ExpressionNode *, int> m_hoisted_expr_offsets;
+  std::unordered_map<std::string, int> m_hoisted_address_offsets;
+  /// @brief Array elements indexed by the variable of an enclosing `for` loop,
+  /// mapped to the slot holding their current address.
+  std::unordered_map<const VariableReferenceNode *, int> m_induction_ref_offsets;
+
+  /// @brief What a loop preheader computed, to be dropped after the loop.
+  struct LoopPreheader
+  {
+    std::vector<const ExpressionNode *> m_exprs;
+    std::vector<std::string> m_globals;
+    std::vector<const VariableReferenceNode *> m_induction_refs;
+  };
+  /// @brief The first occurrences of the common subexpressions, whose value is
+  /// stored to a slot once computed.
+  std::unordered_map<const ExpressionNode *, int> m_cse_save_offsets;
+  /// @brief Slots for common subexpressions, shared by the basic blocks of a
+  /// function; nested blocks (of inlined calls) take the ones after `in_use`.
+  std::vector<int> m_cse_slots;
+  size_t m_cse_slots_in_use = 0;
+
+  /// @brief Decides which calls are expanded in place of a `jal`.
+  InlineAnalyzer m_inline_analyzer;
+  /// @brief Greater than 0 while emitting the body of an inlined function.
+  int m_inline_depth = 0;
+  bool m_report_inlining = false;
+  /// @brief The names read in the function being emitted.
+  DeadStoreAnalyzer m_dead_stores;
+  bool m_gc_functions = false;
+  /// @brief Whether the program body is emitted as `main`; a library unit only
+  /// provides its globals and functions to other units.
+  bool m_emits_main = true;
+  /// @brief The precompiled prelude whose globals are defined along with the
+  /// ones of the program; null if none.
+  const ProgramNode *m_prelude = nullptr;
+  std::string m_current_function_name;
+  /// @brief The parameter slots of the current function and the label right
+  /// after they are stored, which a self tail call jumps back to.
+  const FunctionNode *m_current_function = nullptr;
+  std::vector<int> m_parameter_offsets;
+  int m_tail_call_label = 0;
+  /// @brief Where each parameter of the current function is passed: an `a` or
+  /// `fa` register, or an empty string for the stack.
+  std::vector<std::string> m_parameter_registers;
+  /// @brief The type `return` coerces to, i.e., that of the function being
+  /// emitted (or inlined).
+  const PType *m_return_type = nullptr;
+
+  /// @brief The bit patterns of the single-precision constants, emitted to
+  /// `.rodata` after the code as `.LR<bits>`.
+  std::vector<uint32_t> m_real_constants;
+  std::unordered_set<uint32_t> m_pooled_reals;
+  /// @brief The contents of the string literals, emitted as `.LS<hash>`; equal
+  /// literals share a label.
+  std::vector<std::string> m_string_constants;
+  std::unordered_set<std::string> m_pooled_strings;
+
+  /// @brief Reuses the code of functions that are unchanged since a previous
+  /// compile; disabled if null.
+  std::unique_ptr<FunctionCache> m_function_cache;
+  /// @brief The cache key of each function, from its own content and what its
+  /// code depends on elsewhere in the program.
+  std::unordered_map<std::string, uint64_t> m_function_cache_keys;
+  /// @brief The entry of the function being emitted, which collects the
+  /// constants it refers to; null unless the function is being cached.
+  CachedFunction *m_cached_function = nullptr;
 
   bool m_assign_left = false;
   bool m_is_in_declaration = false;
   bool m_is_in_function_invocation = false;
-  bool m_is_binary_condition = false;
-  bool m_is_in_if = false;
   bool m_is_in_read = false;
-  bool m_assign_bool = false;
   int m_label_count = 1;
+  std::string m_label_prefix;
   int m_parameter_count = 0;
-  int jump_label = 0;
 
 public:
   ~CodeGenerator() = default;
@@ -39,7 +129,21 @@ public:
                 const std::string &save_path,
                 std::unordered_map<SemanticAnalyzer::AstNodeAddr,
                                    SymbolManager::Table>
-                    &&p_symbol_table_of_scoping_nodes);
+                    p_symbol_table_of_scoping_nodes);
+
+  /// @brief Reports every inlined call site to `stderr`.
+  void setReportInlining(const bool p_report) { m_report_inlining = p_report; }
+  /// @brief Skips functions that are never called out of line from main.
+  void setGcFunctions(const bool p_gc) { m_gc_functions = p_gc; }
+  /// @brief Omits `main`, which also keeps every function since any of them
+  /// may be called from another unit.
+  void setEmitsMain(const bool p_emits_main) { m_emits_main = p_emits_main; }
+  /// @brief Defines the globals of the prelude, whose symbols seeded the
+  /// global scope, before those of the program.
+  void setPrelude(const ProgramNode &p_prelude) { m_prelude = &p_prelude; }
+  /// @brief Reuses the code of unchanged functions from `p_directory` and
+  /// stores the code of the others there.
+  void setFunctionCacheDirectory(const std::string &p_directory);
 
   void visit(ProgramNode &p_program) override;
   void visit(DeclNode &p_decl) override;
@@ -58,6 +162,124 @@ public:
   void visit(WhileNode &p_while) override;
   void visit(ForNode &p_for) override;
   void visit(ReturnNode &p_return) override;
+
+private:
+  /// @brief Materializes `p_value` in `p_reg` with a single `li` if it fits in
+  /// a 12-bit signed immediate, or with `lui` + `addi` otherwise.
+  void emitLoadImmediate(const char *p_reg, int64_t p_value);
+  /// @brief Emits `t0 = t1 <op> p_imm` with an I-type instruction.
+  /// @return `false` if `p_op` has no immediate form for `p_imm`, in which
+  /// case nothing is emitted.
+  bool emitImmediateBinaryOp(Operator p_op, int64_t p_imm);
+
+  /// @brief Pushes the symbol table of a scoping node as the new scope.
+  void enterScope(const AstNode &p_node);
+  /// @brief Pops the scope of `p_node`; its table stays in the store, so that
+  /// the node can be emitted again, e.g., when its function is inlined.
+  void leaveScope(const AstNode &p_node);
+  int getFrameOffset(const SymbolEntry &p_entry) const
+  {
+    return m_frame_offsets.at(&p_entry);
+  }
+
+  /// @brief Expands the body of the callee at the call site if the inliner
+  /// picked it. The arguments are bound to fresh slots in the current frame.
+  /// @return `false` if the call is not inlined; nothing is emitted.
+  bool emitInlinedCall(FunctionInvocationNode &p_func_invocation);
+
+  /// @brief Emits the declarations and statements of a block. The value of a
+  /// function invocation used as a statement is dropped.
+  void visitStatements(const CompoundStatementNode &p_block);
+
+  /// @brief Numbers the values of a basic block and sets up the slots for its
+  /// common subexpressions, which are appended to `p_exprs`.
+  void beginBasicBlock(const std::vector<const AstNode *> &p_block,
+                       std::vector<const ExpressionNode *> &p_exprs);
+  void endBasicBlock(std::vector<const ExpressionNode *> &p_exprs);
+  /// @brief Stores the value just pushed in t0 if later expressions reuse it.
+  void saveCommonValue(const ExpressionNode &p_expr);
+  void emitBinaryOperator(BinaryOperatorNode &p_bin_op);
+  /// @brief Emits an arithmetic or comparison operator on reals with `ft0` and
+  /// `ft1`, converting an integer operand first.
+  void emitRealBinaryOperator(BinaryOperatorNode &p_bin_op);
+
+  /// @brief Pushes the value of the expression converted to `p_type` where
+  /// `canCoerceTo` allows it, i.e., from integer to real.
+  void visitCoerced(ExpressionNode &p_expr, const PType *p_type);
+  /// @return The label holding the value as a float. It is named after the
+  /// bits of the value, so the code of a function refers to it by the same
+  /// name in every compile.
+  std::string getRealConstantLabel(double p_value);
+  /// @return The label holding the string, named after a hash of it.
+  std::string getStringConstantLabel(const std::string &p_string);
+  void poolRealConstant(uint32_t p_bits);
+  void poolStringConstant(const std::string &p_string);
+  /// @brief Emits the pooled real and string constants to `.rodata`.
+  void emitConstantPool();
+
+  /// @brief Hashes every function and derives its cache key from its own hash,
+  /// the hash of the global declarations, and the hash of each callee along
+  /// with whether calls to it are inlined.
+  void computeFunctionCacheKeys(ProgramNode &p_program);
+  /// @return `false` if the function is not in the cache; nothing is emitted.
+  bool emitCachedFunction(const FunctionNode &p_function);
+  /// @brief Emits the code of the function, storing it to the cache if any.
+  void emitFunction(FunctionNode &p_function);
+
+  /// @brief Lowers `return f(...)` to a jump that reuses the frame. A self
+  /// tail call overwrites the parameters and jumps back to the top of the body;
+  /// any other tail call passes its arguments in `a0`-`a7`, tears down the frame
+  /// and jumps to the callee, which then returns to our caller.
+  /// @return `false` if the return value is not a tail call; nothing is emitted.
+  bool emitTailCall(const ReturnNode &p_return);
+
+  /// @return Whether storing to `p_lvalue` can be dropped since it is a local
+  /// scalar that the current function never reads.
+  bool isDeadStore(const VariableReferenceNode &p_lvalue) const;
+
+  /// @return The frame-pointer offset of a new 4-byte slot in the current frame.
+  int allocateFrameSlot();
+  /// @brief Redirects the output to a buffer until `endFunctionBody`.
+  /// @param p_saves_s1 Whether the prologue has to save s1 for the body.
+  void beginFunctionBody(const bool p_saves_s1);
+  /// @brief Emits the prologue sized for the slots allocated since
+  /// `beginFunctionBody`, followed by the buffered body.
+  void endFunctionBody();
+
+  /// @brief Computes the invariant parts of the loop once, before its header,
+  /// as well as the initial address of the array elements indexed by the loop
+  /// variable of a `for` loop.
+  void emitLoopPreheader(AstNode &p_loop, LoopPreheader &p_preheader);
+  /// @brief Advances the address of every array element indexed by the loop
+  /// variable to the next iteration.
+  void emitInductionStep(const LoopPreheader &p_preheader);
+  void dropHoistedValues(const LoopPreheader &p_preheader);
+  /// @return `false` if the expression is not hoisted; nothing is emitted.
+  bool pushHoistedValue(const ExpressionNode &p_expr);
+  /// @brief Lowers a boolean expression to compare-and-branch instructions,
+  /// short-circuiting `and` and `or`. A label of 0 means that outcome falls
+  /// through to the code emitted next; at most one of them may be 0.
+  void genCondBranch(const ExpressionNode &p_cond, int p_true_label,
+                     int p_false_label);
+  /// @brief Emits `p_mnemonic p_lhs, p_rhs` to `p_true_label`, followed by a
+  /// jump to `p_false_label` unless it is 0.
+  void emitBranch(const char *p_mnemonic, const char *p_lhs, const char *p_rhs,
+                  int p_true_label, int p_false_label);
+  /// @brief Restores ra, s0 (and s1) and pops the frame; the caller emits the
+  /// jump that follows.
+  void emitFrameTeardown();
+  /// @brief Calls a routine of the runtime, whose arguments are in registers
+  /// already, with sp aligned to 16 bytes as for a function; s1 keeps the
+  /// unaligned sp across the call.
+  void emitRuntimeCall(const char *p_routine);
+  /// @brief Loads the address of the first element of the array into t0.
+  void emitArrayBase(const SymbolEntry &p_entry);
+  /// @brief Pushes the address of the (possibly partially) indexed array
+  /// element, in row-major order.
+  void emitElementAddress(const VariableReferenceNode &p_ref,
+                          const SymbolEntry &p_entry);
+  /// @brief Loads the address of the global into `p_reg`.
+  void emitGlobalAddress(const char *p_reg, const char *p_name);
 };
 
 #endif
@@ -0,0 +1,52 @@
+#ifndef CODEGEN_DEAD_STORE_ANALYZER_H
+#define CODEGEN_DEAD_STORE_ANALYZER_H
+
+#include "visitor/AstNodeVisitor.hpp"
+
+#include <set>
+#include <string>
+
+class AstNode;
+class ExpressionNode;
+
+/// @brief Collects the names whose value is read somewhere in a function body,
+/// so that the code generator can drop stores to locals that are never read.
+///
+/// The analysis works on names and ignores control flow: a local is live if a
+/// variable of the same name is read anywhere in the body, even in another
+/// scope or before the store.
+class DeadStoreAnalyzer final : public AstNodeVisitor {
+  private:
+    std::set<std::string> m_read_names;
+
+  public:
+    ~DeadStoreAnalyzer() = default;
+    DeadStoreAnalyzer() = default;
+
+    /// @param p_body The body of a function or of the main program.
+    void analyze(AstNode &p_body);
+
+    bool isRead(const std::string &p_name) const {
+        return m_read_names.count(p_name) != 0;
+    }
+
+    /// @return Whether evaluating the expression may have side effects, i.e.,
+    /// whether it invokes a function.
+    static bool hasSideEffects(const ExpressionNode &p_expr);
+
+    void visit(DeclNode &p_decl) override;
+    void visit(CompoundStatementNode &p_compound_statement) override;
+    void visit(PrintNode &p_print) override;
+    void visit(BinaryOperatorNode &p_bin_op) override;
+    void visit(UnaryOperatorNode &p_un_op) override;
+    void visit(FunctionInvocationNode &p_func_invocation) override;
+    void visit(VariableReferenceNode &p_variable_ref) override;
+    void visit(AssignmentNode &p_assignment) override;
+    void visit(ReadNode &p_read) override;
+    void visit(IfNode &p_if) override;
+    void visit(WhileNode &p_while) override;
+    void visit(ForNode &p_for) override;
+    void visit(ReturnNode &p_return) override;
+};
+
+#endif
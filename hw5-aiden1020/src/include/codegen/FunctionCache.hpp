@@ -0,0 +1,38 @@
+#ifndef CODEGEN_FUNCTION_CACHE_H
+#define CODEGEN_FUNCTION_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief The assembly emitted for a function, along with the pooled
+/// constants that it refers to, which are emitted after all functions.
+struct CachedFunction {
+    std::string m_assembly;
+    std::vector<uint32_t> m_real_constants;
+    std::vector<std::string> m_string_constants;
+};
+
+/// @brief An on-disk cache of the assembly of functions, keyed by a hash of
+/// everything the code generated for the function depends on. Each entry is a
+/// file in the cache directory.
+class FunctionCache {
+  private:
+    std::string m_directory;
+
+  public:
+    ~FunctionCache() = default;
+    /// @param p_directory Created, along with its parents, if it does not exist.
+    explicit FunctionCache(const std::string &p_directory);
+
+    /// @return `false` if there is no (readable) entry for the key.
+    bool load(uint64_t p_key, CachedFunction &p_function) const;
+    /// @brief Writes the entry to a temporary file first and renames it, so
+    /// that a concurrent compile never reads a partial entry.
+    void store(uint64_t p_key, const CachedFunction &p_function) const;
+
+  private:
+    std::string pathOf(uint64_t p_key) const;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef CODEGEN_FUNCTION_HASHER_H
+#define CODEGEN_FUNCTION_HASHER_H
+
+#include "visitor/AstNodeVisitor.hpp"
+
+#include <cstdint>
+#include <set>
+#include <string>
+
+class AstNode;
+class Constant;
+
+/// @brief Computes a content hash of an AST subtree, e.g., of a function with
+/// its signature and body, for the function cache of the code generator.
+///
+/// The hash covers the kind of every node and what the code generated for it
+/// depends on (names, types, operators and constant values) but not source
+/// locations, so that moving a function around does not change its hash.
+class FunctionHasher final : public AstNodeVisitor {
+  private:
+    uint64_t m_hash = kOffsetBasis;
+    std::set<std::string> m_callees;
+
+  public:
+    /// The initial value of 64-bit FNV-1a.
+    static constexpr uint64_t kOffsetBasis = 0xcbf29ce484222325ULL;
+
+    ~FunctionHasher() = default;
+    FunctionHasher() = default;
+
+    /// @return The hash of the subtree rooted at `p_node`.
+    uint64_t hash(AstNode &p_node);
+    /// @return The names of the functions invoked in the last hashed subtree.
+    const std::set<std::string> &getCallees() const { return m_callees; }
+
+    /// @return The 64-bit FNV-1a hash of `p_string` continued from `p_seed`.
+    static uint64_t hashString(const std::string &p_string,
+                               uint64_t p_seed = kOffsetBasis);
+    /// @return A token that tells every value of the constant apart. The text
+    /// of a real keeps only 6 decimals, so a real is spelled by its bits.
+    static std::string keyOf(const Constant &p_constant);
+
+    void visit(ProgramNode &p_program) override;
+    void visit(DeclNode &p_decl) override;
+    void visit(VariableNode &p_variable) override;
+    void visit(ConstantValueNode &p_constant_value) override;
+    void visit(FunctionNode &p_function) override;
+    void visit(CompoundStatementNode &p_compound_statement) override;
+    void visit(PrintNode &p_print) override;
+    void visit(BinaryOperatorNode &p_bin_op) override;
+    void visit(UnaryOperatorNode &p_un_op) override;
+    void visit(FunctionInvocationNode &p_func_invocation) override;
+    void visit(VariableReferenceNode &p_variable_ref) override;
+    void visit(AssignmentNode &p_assignment) override;
+    void visit(ReadNode &p_read) override;
+    void visit(IfNode &p_if) override;
+    void visit(WhileNode &p_while) override;
+    void visit(ForNode &p_for) override;
+    void visit(ReturnNode &p_return) override;
+
+  private:
+    /// @brief Feeds a token followed by a separator, so that consecutive
+    /// tokens cannot run into each other.
+    void add(const std::string &p_token);
+    /// @brief Feeds the token of a node, then its children and an end marker,
+    /// which keeps the shape of the tree in the hash.
+    template <typename NodeT>
+    void addNode(const std::string &p_token, NodeT &p_node);
+};
+
+#endif
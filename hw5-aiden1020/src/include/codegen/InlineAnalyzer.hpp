@@ -0,0 +1,94 @@
+#ifndef CODEGEN_INLINE_ANALYZER_H
+#define CODEGEN_INLINE_ANALYZER_H
+
+#include "visitor/AstNodeVisitor.hpp"
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+
+class FunctionNode;
+
+/// @brief Decides which functions the code generator expands at their call
+/// sites instead of emitting a `jal`.
+///
+/// Only leaf functions are inlined, i.e., functions that invoke no other
+/// function (which also rules out recursion). Their body must either have no
+/// `return` at all or a single `return` as its last statement, so that the
+/// inlined body simply leaves the returned value on the stack.
+///
+/// A function is inlined if it is small, or if it is called only once. The
+/// size is the number of statement and expression nodes in its body.
+class InlineAnalyzer final : public AstNodeVisitor {
+  public:
+    /// Functions up to this size are always inlined.
+    static constexpr size_t kAlwaysInlineSize = 12;
+    /// Functions larger than this are never inlined.
+    static constexpr size_t kMaxInlineSize = 48;
+
+  private:
+    struct FunctionInfo {
+        const FunctionNode *m_function = nullptr;
+        size_t m_size = 0;
+        size_t m_num_returns = 0;
+        size_t m_num_call_sites = 0;
+        bool m_has_invocation = false;
+        /// @brief Whether it prints, reads, or concatenates strings, which
+        /// calls a routine of the runtime.
+        bool m_has_runtime_call = false;
+        std::set<std::string> m_callees;
+    };
+
+    std::map<std::string, FunctionInfo> m_functions;
+    FunctionInfo *m_current_function = nullptr;
+
+  public:
+    ~InlineAnalyzer() = default;
+    InlineAnalyzer() = default;
+
+    /// @return `nullptr` if calls to `p_name` should not be inlined.
+    const FunctionNode *getInlineTarget(const std::string &p_name) const;
+    /// @param p_name A function, or the program for its main body.
+    /// @return Whether it calls any function that is not inlined, or a
+    /// routine of the runtime, also from the bodies inlined into it.
+    bool hasOutOfLineCall(const std::string &p_name) const;
+    /// @param p_program_name The name of the program, i.e., the main body.
+    /// @return The functions reachable from the main body through calls that
+    /// are not inlined.
+    std::set<std::string> collectLiveFunctions(const std::string &p_program_name) const;
+    /// @return The size of the function as used by the heuristic.
+    size_t getSize(const std::string &p_name) const;
+
+    void visit(ProgramNode &p_program) override;
+    void visit(DeclNode &p_decl) override;
+    void visit(VariableNode &p_variable) override;
+    void visit(ConstantValueNode &p_constant_value) override;
+    void visit(FunctionNode &p_function) override;
+    void visit(CompoundStatementNode &p_compound_statement) override;
+    void visit(PrintNode &p_print) override;
+    void visit(BinaryOperatorNode &p_bin_op) override;
+    void visit(UnaryOperatorNode &p_un_op) override;
+    void visit(FunctionInvocationNode &p_func_invocation) override;
+    void visit(VariableReferenceNode &p_variable_ref) override;
+    void visit(AssignmentNode &p_assignment) override;
+    void visit(ReadNode &p_read) override;
+    void visit(IfNode &p_if) override;
+    void visit(WhileNode &p_while) override;
+    void visit(ForNode &p_for) override;
+    void visit(ReturnNode &p_return) override;
+
+  private:
+    void count() {
+        if (m_current_function) {
+            ++m_current_function->m_size;
+        }
+    }
+    void markRuntimeCall() {
+        if (m_current_function) {
+            m_current_function->m_has_runtime_call = true;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef CODEGEN_LOCAL_VALUE_NUMBERING_H
+#define CODEGEN_LOCAL_VALUE_NUMBERING_H
+
+#include "sema/SymbolTable.hpp"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class AstNode;
+class ExpressionNode;
+class VariableReferenceNode;
+
+/// @brief Finds the common subexpressions of a basic block, i.e., a run of
+/// statements without control flow, by local value numbering.
+///
+/// Every expression gets a value number from its operator and the value
+/// numbers of its operands; a variable gets a new value number whenever it is
+/// assigned or read into, and every global does after a function invocation.
+/// Arrays are passed by address, so an array parameter may alias any other
+/// array: every array gets a new value number after an invocation and after a
+/// store to any array element.
+/// Operator expressions and array elements that share a value number with an
+/// earlier one in the block are reported so that the code generator can keep
+/// the first value in a frame slot and reload it instead of recomputing it.
+class LocalValueNumbering {
+  private:
+    /// Expressions whose value is already kept somewhere else; they are
+    /// numbered as unique values and not looked into.
+    const std::unordered_map<const ExpressionNode *, int> &m_opaque_exprs;
+
+    std::map<std::string, int> m_value_numbers;
+    std::map<std::string, int> m_versions;
+    int m_call_epoch = 0;
+    int m_array_epoch = 0;
+    int m_num_unique_values = 0;
+
+    struct Occurrence {
+        const ExpressionNode *m_expr;
+        int m_value_number;
+    };
+    std::vector<Occurrence> m_occurrences;
+    /// Greater than 0 while numbering an operand that may be skipped by
+    /// short-circuit evaluation; what it computes cannot be reused.
+    int m_conditional_depth = 0;
+
+    std::vector<const ExpressionNode *> m_saved_exprs;
+    std::unordered_map<const ExpressionNode *, const ExpressionNode *> m_reused_exprs;
+
+  public:
+    ~LocalValueNumbering() = default;
+    explicit LocalValueNumbering(
+        const std::unordered_map<const ExpressionNode *, int> &p_opaque_exprs)
+        : m_opaque_exprs(p_opaque_exprs) {}
+
+    /// @param p_block The statements of the block in the order they are emitted.
+    void analyze(const std::vector<const AstNode *> &p_block);
+
+    /// @return The first occurrences of the values computed more than once,
+    /// in evaluation order.
+    const std::vector<const ExpressionNode *> &getSavedExpressions() const {
+        return m_saved_exprs;
+    }
+    /// @return The later occurrences, mapped to the first one of their value.
+    const std::unordered_map<const ExpressionNode *, const ExpressionNode *> &
+    getReusedExpressions() const {
+        return m_reused_exprs;
+    }
+
+  private:
+    void numberStatement(const AstNode &p_statement);
+    int numberExpression(const ExpressionNode &p_expr);
+    int valueNumberOf(const std::string &p_key);
+    int newUniqueValue();
+    void addOccurrence(const ExpressionNode &p_expr, int p_value_number);
+    std::string versionedName(const VariableReferenceNode &p_ref) const;
+    void invalidate(const VariableReferenceNode &p_target);
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef CODEGEN_LOOP_INVARIANT_ANALYZER_H
+#define CODEGEN_LOOP_INVARIANT_ANALYZER_H
+
+#include "sema/SymbolTable.hpp"
+#include "visitor/AstNodeVisitor.hpp"
+
+#include <set>
+#include <string>
+#include <vector>
+
+class AstNode;
+class ExpressionNode;
+class VariableReferenceNode;
+
+/// @brief Finds the parts of a `while` or `for` loop whose value cannot change
+/// while the loop runs, so that the code generator can compute them once in
+/// the preheader (the code right before the loop header) instead of on every
+/// iteration.
+///
+/// The analysis is conservative and works on names: every name that is
+/// assigned, read into, or declared anywhere inside the loop is considered
+/// modified, and a function invocation inside the loop is assumed to modify
+/// every global variable.
+class LoopInvariantAnalyzer final : public AstNodeVisitor {
+  private:
+    enum class Phase { kCollectModified, kFindInvariants };
+
+    Phase m_phase = Phase::kCollectModified;
+
+    std::set<std::string> m_modified_names;
+    std::set<std::string> m_declared_names;
+    bool m_has_invocation = false;
+
+    std::vector<ExpressionNode *> m_invariant_exprs;
+    std::set<std::string> m_global_names;
+
+    std::string m_induction_var;
+    std::vector<VariableReferenceNode *> m_induction_refs;
+
+  public:
+    ~LoopInvariantAnalyzer() = default;
+    LoopInvariantAnalyzer() = default;
+
+    /// @param p_loop A `WhileNode` or a `ForNode`.
+    void analyze(AstNode &p_loop);
+
+    /// @return The maximal invariant operator expressions in evaluation order.
+    /// Bare variable references and constants are not reported since they are
+    /// already a single load.
+    const std::vector<ExpressionNode *> &getInvariantExpressions() const {
+        return m_invariant_exprs;
+    }
+    /// @return The global variables and constants referenced in the loop;
+    /// their addresses are invariant even if their values are not.
+    const std::set<std::string> &getReferencedGlobals() const {
+        return m_global_names;
+    }
+    /// @return The array references in a `for` loop whose last index is the
+    /// loop variable and whose other indices are invariant. Their address
+    /// advances by a constant stride on every iteration.
+    const std::vector<VariableReferenceNode *> &getInductionReferences() const {
+        return m_induction_refs;
+    }
+
+    void visit(DeclNode &p_decl) override;
+    void visit(VariableNode &p_variable) override;
+    void visit(CompoundStatementNode &p_compound_statement) override;
+    void visit(PrintNode &p_print) override;
+    void visit(BinaryOperatorNode &p_bin_op) override;
+    void visit(UnaryOperatorNode &p_un_op) override;
+    void visit(FunctionInvocationNode &p_func_invocation) override;
+    void visit(VariableReferenceNode &p_variable_ref) override;
+    void visit(AssignmentNode &p_assignment) override;
+    void visit(ReadNode &p_read) override;
+    void visit(IfNode &p_if) override;
+    void visit(WhileNode &p_while) override;
+    void visit(ForNode &p_for) override;
+    void visit(ReturnNode &p_return) override;
+
+  private:
+    bool isInvariant(const ExpressionNode &p_expr) const;
+    bool isGlobal(const VariableReferenceNode &p_ref) const;
+    bool isInductionReference(const VariableReferenceNode &p_ref) const;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef SEMA_CHECKED_MODULE_H
+#define SEMA_CHECKED_MODULE_H
+
+#include "AST/program.hpp"
+#include "sema/InterfaceFile.hpp"
+#include "sema/SemanticAnalyzer.hpp"
+#include "sema/SymbolTable.hpp"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief A type-checked program, i.e., its AST with the inferred types and
+/// the symbol tables of its scoping nodes, saved to a file so that the back
+/// end can run on it again without scanning, parsing, or checking the source.
+///
+/// Nodes are numbered in the order they are written, which is the pre-order
+/// of the tree, and a symbol table refers to its scoping node and to the node
+/// that declares each of its symbols by that number. Integers are written as
+/// LEB128 varints. The file ends with the byte offset of every node, so that
+/// a tool can map the file and decode any single node.
+class CheckedModule {
+  public:
+    using SymbolTables =
+        std::unordered_map<SemanticAnalyzer::AstNodeAddr, SymbolManager::Table>;
+
+  private:
+    std::string m_source_path;
+    std::unique_ptr<ProgramNode> m_program;
+    /// @brief The declarations imported from interface files, which the
+    /// global symbol table refers to.
+    ProgramNode::DeclNodes m_imported_decl_nodes;
+    ProgramNode::FuncNodes m_imported_func_nodes;
+    SymbolTables m_symbol_table_of_scoping_nodes;
+
+  public:
+    ~CheckedModule() = default;
+    CheckedModule() = default;
+
+    /// @param p_imports The interfaces the program was checked with.
+    /// @return `false` if the file cannot be written.
+    static bool write(const std::string &p_path,
+                      const std::string &p_source_path,
+                      const ProgramNode &p_program,
+                      const std::vector<const InterfaceFile *> &p_imports,
+                      const SymbolTables &p_symbol_tables);
+    /// @return `nullptr` if the file cannot be read or is malformed, i.e.,
+    /// does not decode or leaves a scope without its table or a name
+    /// unresolved; the reason is printed to `stderr`.
+    static std::unique_ptr<CheckedModule> read(const std::string &p_path);
+
+    const std::string &getSourcePath() const { return m_source_path; }
+    ProgramNode &getProgram() { return *m_program; }
+    /// @return The table of global symbols, including the program itself.
+    const SymbolTable &getGlobalSymbolTable() const {
+        return *m_symbol_table_of_scoping_nodes.at(m_program.get());
+    }
+    /// @return Whether the program only declares globals and functions,
+    /// without any code, so that it can serve as the prelude of others.
+    bool isPrelude() const;
+    /// @note Can only be called once, like the one of `SemanticAnalyzer`.
+    SymbolTables &&acquireSymbolTableOfScopingNodes() {
+        return std::move(m_symbol_table_of_scoping_nodes);
+    }
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SEMA_DIAGNOSTIC_ENGINE_HPP
+#define SEMA_DIAGNOSTIC_ENGINE_HPP
+
+#include "AST/ast.hpp"
+#include "sema/Error.hpp"
+#include "sema/ErrorPrinter.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Collects the errors of a compilation and prints them all at once,
+/// sorted by location, when `flush()` is called.
+///
+/// A lookup error that repeats the kind and the symbol of an earlier one is
+/// not kept again; the earlier one records its location instead. Once the
+/// limit is reached, errors that are not repeats are only counted.
+class DiagnosticEngine {
+public:
+  /// @param p_error_limit The number of distinct errors kept; 0 keeps all.
+  /// @note The printer must outlive the engine.
+  explicit DiagnosticEngine(const ErrorPrinter &p_printer,
+                            uint32_t p_error_limit = 0);
+
+  void report(const Error &p_error);
+  /// @brief Reports an error that is not found by the semantic analysis.
+  void report(const char *p_id, Location p_location, std::string p_message,
+              const std::string &p_symbol_name = "");
+
+  const ErrorPrinter &getPrinter() const { return m_printer; }
+
+  /// @brief Prints the errors collected so far and ends the output of the
+  /// printer.
+  void flush();
+
+private:
+  struct Diagnostic {
+    const char *m_id;
+    Location m_location;
+    std::string m_message;
+    /// @brief The locations of the repeats, in the order they are found.
+    std::vector<Location> m_repeats;
+  };
+
+  const ErrorPrinter &m_printer;
+  uint32_t m_error_limit;
+  std::vector<Diagnostic> m_diagnostics;
+  /// @brief Maps the id and the symbol of an error to its index in
+  /// `m_diagnostics`.
+  std::unordered_map<std::string, size_t> m_index_of_symbol_error;
+  uint32_t m_num_dropped{0};
+
+  /// @return Whether the error is to be kept; if not, it is recorded either
+  /// as a repeat of an earlier one or counted as one over the limit.
+  bool admit(const char *p_id, Location p_location,
+             const std::string &p_symbol_name);
+};
+
+#endif // SEMA_DIAGNOSTIC_ENGINE_HPP
@@ -14,6 +14,14 @@ class Error {
  public:
   Location getLocation() const;
   virtual std::string getMessage() const = 0;
+  /// @brief A stable, kebab-case name of the kind of the error, such as
+  /// `undeclared-symbol`, for tools that read the diagnostics.
+  virtual const char *getId() const = 0;
+  /// @return The symbol that the error fails to look up, or an empty string
+  /// if the error is not about a lookup. A lookup error that repeats the kind
+  /// and the symbol of an earlier one is folded into it; any other error
+  /// needs its own fix, so it is always reported on its own.
+  virtual std::string getSymbolName() const;
 
   Error(Location);
   virtual ~Error() = default;
@@ -38,6 +46,7 @@ class Error {
 class SymbolRedeclarationError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
 
   SymbolRedeclarationError(Location, std::string p_symbol_name);
 
@@ -53,6 +62,7 @@ class SymbolRedeclarationError : public Error {
 class NonPositiveArrayDimensionError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
 
   NonPositiveArrayDimensionError(Location, std::string p_symbol_name);
 
@@ -68,6 +78,8 @@ class NonPositiveArrayDimensionError : public Error {
 class UndeclaredSymbolError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
+  std::string getSymbolName() const override;
 
   UndeclaredSymbolError(Location, std::string p_symbol_name);
 
@@ -80,6 +92,8 @@ class UndeclaredSymbolError : public Error {
 class NonVariableSymbolError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
+  std::string getSymbolName() const override;
 
   NonVariableSymbolError(Location, std::string p_symbol_name);
 
@@ -93,11 +107,13 @@ class NonIntegerArrayIndexError : public Error {
   using Error::Error;
 
   std::string getMessage() const override;
+  const char *getId() const override;
 };
 
 class OverArraySubscriptError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
 
   OverArraySubscriptError(Location, std::string p_symbol_name);
 
@@ -112,6 +128,7 @@ class OverArraySubscriptError : public Error {
 class InvalidBinaryOperandError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
 
   InvalidBinaryOperandError(Location, Operator, const PType *p_lhs,
                             const PType *p_rhs);
@@ -125,6 +142,7 @@ class InvalidBinaryOperandError : public Error {
 class InvalidUnaryOperandError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
 
   InvalidUnaryOperandError(Location, Operator, const PType * p_operand);
 
@@ -141,6 +159,8 @@ class InvalidUnaryOperandError : public Error {
 class NonFunctionSymbolError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
+  std::string getSymbolName() const override;
 
   NonFunctionSymbolError(Location, std::string p_symbol_name);
 
@@ -152,6 +172,7 @@ class NonFunctionSymbolError : public Error {
 class ArgumentNumberMismatchError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
 
   ArgumentNumberMismatchError(Location, std::string p_function_name);
 
@@ -164,6 +185,7 @@ class ArgumentNumberMismatchError : public Error {
 class IncompatibleArgumentTypeError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
 
   IncompatibleArgumentTypeError(Location, const PType *p_expected,
                                 const PType *p_actual);
@@ -183,6 +205,7 @@ class PrintOutNonScalarTypeError : public Error {
   using Error::Error;
 
   std::string getMessage() const override;
+  const char *getId() const override;
 };
 
 /// @brief The type of the variable reference must be scalar type.
@@ -191,6 +214,7 @@ class ReadToNonScalarTypeError : public Error {
   using Error::Error;
 
   std::string getMessage() const override;
+  const char *getId() const override;
 };
 
 /// @brief The kind of symbol of the variable reference cannot be constant or
@@ -200,6 +224,7 @@ class ReadToConstantOrLoopVarError : public Error {
   using Error::Error;
 
   std::string getMessage() const override;
+  const char *getId() const override;
 };
 
 //
@@ -211,6 +236,7 @@ class AssignWithArrayTypeError : public Error {
   using Error::Error;
 
   std::string getMessage() const override;
+  const char *getId() const override;
 };
 
 // One might want to use the following aliases to make the error more
@@ -226,6 +252,7 @@ using AssignByArrayTypeError = AssignWithArrayTypeError;
 class AssignToConstantError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
 
   AssignToConstantError(Location, std::string p_symbol_name);
 
@@ -240,6 +267,7 @@ class AssignToLoopVarError : public Error {
   using Error::Error;
 
   std::string getMessage() const override;
+  const char *getId() const override;
 };
 
 /// @brief The type of the variable reference (lvalue) must be the same as the
@@ -247,6 +275,7 @@ class AssignToLoopVarError : public Error {
 class IncompatibleAssignmentError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
 
   IncompatibleAssignmentError(Location, const PType *p_lval,
                               const PType *p_rval);
@@ -267,6 +296,7 @@ class NonBooleanConditionError : public Error {
   using Error::Error;
 
   std::string getMessage() const override;
+  const char *getId() const override;
 };
 
 //
@@ -280,6 +310,7 @@ class NonIncrementalLoopVariableError : public Error {
   using Error::Error;
 
   std::string getMessage() const override;
+  const char *getId() const override;
 };
 
 //
@@ -293,6 +324,7 @@ class ReturnFromVoidError : public Error {
   using Error::Error;
 
   std::string getMessage() const override;
+  const char *getId() const override;
 };
 
 /// @brief The type of the result of the expression (return value) must be the
@@ -301,6 +333,7 @@ class ReturnFromVoidError : public Error {
 class IncompatibleReturnTypeError : public Error {
  public:
   std::string getMessage() const override;
+  const char *getId() const override;
 
   IncompatibleReturnTypeError(Location, const PType *p_expected,
                               const PType *p_actual);
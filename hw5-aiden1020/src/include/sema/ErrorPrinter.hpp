@@ -1,22 +1,89 @@
 #ifndef SEMA_ERROR_PRINTER_HPP
 #define SEMA_ERROR_PRINTER_HPP
 
+#include "AST/ast.hpp"
 #include "sema/Error.hpp"
+#include "util/LineIndex.hpp"
+#include <cstdint>
 #include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
 
 class ErrorPrinter {
 public:
+  enum class Format : uint8_t {
+    /// @brief For humans: the message, then the source line with a caret.
+    kText,
+    /// @brief One JSON object per line for each error.
+    kJson,
+    /// @brief A single SARIF 2.1.0 log, written out by `finish()`.
+    kSarif
+  };
+
   /// @brief Prints the location of the error, the description of the error, and
   /// the source line that causes the error.
   void print(const Error &) const;
 
+  /// @brief Prints an error that is not found by the semantic analysis, such
+  /// as a syntax error, in the same way.
+  /// @param p_repeats The locations of the later occurrences of the error,
+  /// which are folded into the first one.
+  void print(const char *p_id, Location p_location,
+             const std::string &p_message,
+             const std::vector<Location> &p_repeats = {}) const;
+
+  /// @brief Prints a line that is not an error, such as the number of errors
+  /// left out. A SARIF log keeps it as a tool execution notification, written
+  /// out by `finish()`.
+  /// @param p_count The number of errors the note is about.
+  void printNote(const char *p_id, const std::string &p_message,
+                 uint32_t p_count) const;
+
+  Format getFormat() const { return m_format; }
+
+  /// @brief Ends the output; only a SARIF log needs it, and it has to be called
+  /// even if no error is printed.
+  void finish() const;
+
   /// @param p_file The file to print the error to. The caller is responsible
   /// for ensuring the `p_file` is valid throughout the print and closing the
   /// `p_file` after use.
   explicit ErrorPrinter(std::FILE *p_file);
+  /// @param p_source_path The name of the source file that the JSON and SARIF
+  /// formats report the errors in.
+  ErrorPrinter(std::FILE *p_file, Format p_format, std::string p_source_path);
 
 private:
   std::FILE *m_file;
+  Format m_format{Format::kText};
+  std::string m_source_path;
+  /// @brief The source read back from `yyin` and indexed by line the first
+  /// time an error is printed; the scanners keep no line positions.
+  mutable std::string m_source;
+  mutable std::unique_ptr<LineIndex> m_line_index;
+  mutable uint32_t m_num_printed{0};
+
+  struct Note {
+    const char *m_id;
+    std::string m_message;
+    uint32_t m_count;
+  };
+  mutable std::vector<Note> m_sarif_notes;
+
+  bool loadSource() const;
+  /// @return The text of the line without its newline, or an empty string if
+  /// the source cannot be read back.
+  std::string getSourceLine(uint32_t p_line) const;
+  void printJsonString(const std::string &p_text) const;
+  void printText(Location p_location, const std::string &p_message,
+                 const std::vector<Location> &p_repeats) const;
+  void printJson(const char *p_id, Location p_location,
+                 const std::string &p_message,
+                 const std::vector<Location> &p_repeats) const;
+  void printSarifResult(const char *p_id, Location p_location,
+                        const std::string &p_message,
+                        const std::vector<Location> &p_repeats) const;
 };
 
 #endif // SEMA_ERROR_PRINTER_HPP
@@ -0,0 +1,47 @@
+#ifndef SEMA_INTERFACE_FILE_H
+#define SEMA_INTERFACE_FILE_H
+
+#include "AST/program.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+/// @brief The interface of a separately compiled unit, i.e., the types of its
+/// global variables and constants and the signatures of its functions.
+///
+/// A unit compiled with `--emit-interface` writes its interface, and a unit
+/// that refers to its symbols imports it with `--import`. The importer sees
+/// the globals and functions as if they were declared in its own source but
+/// emits no code for them; the linker resolves the references. The file is
+/// a list of lines
+///
+///     var <name> <type>
+///     const <name> <type> <value>
+///     function <name> <return type> [<parameter type>...]
+///
+/// where a type is written as, e.g., `integer` or `real[2][3]`, a real value
+/// in hexadecimal floating point, and a string value as hexadecimal bytes.
+class InterfaceFile {
+  private:
+    ProgramNode::DeclNodes m_decl_nodes;
+    ProgramNode::FuncNodes m_func_nodes;
+
+  public:
+    ~InterfaceFile() = default;
+    InterfaceFile() = default;
+
+    /// @brief Writes the globals and the functions defined (not only declared)
+    /// in the program.
+    static void write(const ProgramNode &p_program, std::FILE *p_out);
+    /// @return `nullptr` if the file cannot be opened or is malformed; the
+    /// reason is printed to `stderr`.
+    static std::unique_ptr<InterfaceFile> read(const std::string &p_path);
+
+    /// @brief The imported symbols as declarations, which have to be kept
+    /// alive as long as the symbol tables referring to them.
+    const ProgramNode::DeclNodes &getDeclNodes() const { return m_decl_nodes; }
+    const ProgramNode::FuncNodes &getFuncNodes() const { return m_func_nodes; }
+};
+
+#endif
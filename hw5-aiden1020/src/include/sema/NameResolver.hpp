@@ -0,0 +1,58 @@
+#ifndef SEMA_NAME_RESOLVER_H
+#define SEMA_NAME_RESOLVER_H
+
+#include "sema/SemanticAnalyzer.hpp"
+#include "sema/SymbolTable.hpp"
+#include "visitor/AstNodeVisitor.hpp"
+
+#include <unordered_map>
+
+class AstNode;
+
+/// @brief Binds every variable reference and function invocation to the
+/// symbol entry its name refers to, so that the back ends read the binding
+/// instead of looking the name up in the scopes.
+///
+/// Runs once after the semantic analysis, whose own entries move when their
+/// scope is popped, over the frozen symbol tables. The entries of a frozen
+/// table keep their addresses, so the bindings stay valid for as long as the
+/// tables, and the code generators running in parallel share them. The entry
+/// tells the scope depth and, for a global, the label; the frame offset is
+/// assigned by each code generator.
+class NameResolver final : public AstNodeVisitor {
+  public:
+    using SymbolTables =
+        std::unordered_map<SemanticAnalyzer::AstNodeAddr, SymbolManager::Table>;
+
+  private:
+    SymbolManager m_symbol_manager;
+    const SymbolTables &m_symbol_tables;
+
+    void enterScope(const AstNode &p_node);
+    void leaveScope();
+
+  public:
+    ~NameResolver() = default;
+    /// @param p_symbol_tables The tables of the scoping nodes, as acquired
+    /// from the semantic analyzer.
+    explicit NameResolver(const SymbolTables &p_symbol_tables)
+        : m_symbol_manager(false /* no dump */),
+          m_symbol_tables(p_symbol_tables) {}
+
+    void visit(ProgramNode &p_program) override;
+    void visit(FunctionNode &p_function) override;
+    void visit(CompoundStatementNode &p_compound_statement) override;
+    void visit(PrintNode &p_print) override;
+    void visit(BinaryOperatorNode &p_bin_op) override;
+    void visit(UnaryOperatorNode &p_un_op) override;
+    void visit(FunctionInvocationNode &p_func_invocation) override;
+    void visit(VariableReferenceNode &p_variable_ref) override;
+    void visit(AssignmentNode &p_assignment) override;
+    void visit(ReadNode &p_read) override;
+    void visit(IfNode &p_if) override;
+    void visit(WhileNode &p_while) override;
+    void visit(ForNode &p_for) override;
+    void visit(ReturnNode &p_return) override;
+};
+
+#endif
@@ -1,7 +1,8 @@
 #ifndef SEMA_SEMANTIC_ANALYZER_H
 #define SEMA_SEMANTIC_ANALYZER_H
 
-#include "sema/ErrorPrinter.hpp"
+#include "sema/DiagnosticEngine.hpp"
+#include "sema/InterfaceFile.hpp"
 #include "sema/SymbolTable.hpp"
 #include "visitor/AstNodeInclude.hpp"
 #include "visitor/AstNodeVisitor.hpp"
@@ -11,6 +12,7 @@
 #include <set>
 #include <stack>
 #include <unordered_map>
+#include <vector>
 
 class SemanticAnalyzer final : public AstNodeVisitor {
   public:
@@ -35,10 +37,22 @@ class SemanticAnalyzer final : public AstNodeVisitor {
     std::stack<SemanticContext> m_context_stack;
     std::stack<const PType *> m_returned_type_stack;
 
-    std::set<SymbolEntry *> m_error_entry_set;
+    /// @brief The ill-formed symbols, by the address of their names. An entry
+    /// may be copied when its scope is popped, but the name is the one of its
+    /// declaring node.
+    std::set<const std::string *> m_error_entry_set;
+
+    /// @brief The interfaces of other units, whose symbols are added to the
+    /// global scope before those of the program.
+    std::vector<const InterfaceFile *> m_imports;
+    /// @brief The global symbols of a precompiled prelude, which seed the
+    /// global scope as they are, without being checked again.
+    const SymbolTable *m_prelude = nullptr;
 
     bool m_has_error = false;
-    ErrorPrinter m_error_printer;
+    /// @brief Shared with the parser, which reports syntax errors to it in the
+    /// machine-readable formats.
+    DiagnosticEngine &m_diagnostics;
 
   public:
     /// @return The symbol table of the AST nodes that open a scope: program,
@@ -52,8 +66,20 @@ class SemanticAnalyzer final : public AstNodeVisitor {
     }
 
     ~SemanticAnalyzer() = default;
-    SemanticAnalyzer(const bool p_opt_dmp, std::FILE *p_error_stream = stderr)
-        : m_symbol_manager(p_opt_dmp), m_error_printer(p_error_stream) {}
+    /// @note The engine must outlive the analyzer.
+    SemanticAnalyzer(const bool p_opt_dmp, DiagnosticEngine &p_diagnostics)
+        : m_symbol_manager(p_opt_dmp), m_diagnostics(p_diagnostics) {}
+
+    /// @note The interface must outlive the symbol tables, which refer to it.
+    void addImport(const InterfaceFile &p_interface) {
+        m_imports.push_back(&p_interface);
+    }
+
+    /// @note The table, and the nodes it refers to, must outlive the symbol
+    /// tables of the program.
+    void setPrelude(const SymbolTable &p_global_table) {
+        m_prelude = &p_global_table;
+    }
 
     void visit(ProgramNode &p_program) override;
     void visit(DeclNode &p_decl) override;
@@ -76,8 +102,9 @@ class SemanticAnalyzer final : public AstNodeVisitor {
     bool hasError() const { return m_has_error; }
 
   private:
-    /// @brief Prints the error and sets the error flag to `true`.
-    /// @note Call this function instead of using the error printer directly.
+    /// @brief Reports the error, which is printed once the analysis is done, and
+    /// sets the error flag to `true`.
+    /// @note Call this function instead of using the diagnostic engine directly.
     void printError(const Error&);
     /// @brief In addition to printing `printError`, the type of the expression
     /// is set as `kErrorType`.
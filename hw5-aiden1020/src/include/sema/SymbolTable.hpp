@@ -7,8 +7,10 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <deque>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 /*
@@ -63,7 +65,6 @@ private:
   size_t m_level;
   const PType *m_p_type;
   Attribute m_attribute;
-  int m_offset;
 
 public:
   ~SymbolEntry() = default;
@@ -90,23 +91,23 @@ public:
   const PType *getTypePtr() const { return m_p_type; }
 
   const Attribute &getAttribute() const { return m_attribute; }
-
-  void setOffset(int p_offset) { m_offset = p_offset; }
-
-  const int getOffset() const { return m_offset; }
 };
 
 class SymbolTable
 {
 private:
-  std::vector<std::unique_ptr<SymbolEntry>> m_entries;
+  std::vector<SymbolEntry> m_entries;
 
 public:
   ~SymbolTable() = default;
   SymbolTable() = default;
+  explicit SymbolTable(std::vector<SymbolEntry> p_entries)
+      : m_entries(std::move(p_entries)) {}
 
   /// @return `nullptr` if not found.
   const SymbolEntry *lookup(const std::string &p_name) const;
+  /// @return The entries in the order they are added.
+  const std::vector<SymbolEntry> &getEntries() const { return m_entries; }
 
   SymbolEntry *addSymbol(const std::string &p_name,
                          const SymbolEntry::KindEnum p_kind, const size_t p_level,
@@ -119,13 +120,34 @@ public:
   void dump() const;
 };
 
+/// @brief The scopes being analyzed, kept as one stack of entries with a
+/// marker where each scope begins.
+///
+/// Entries are added in place and a scope is popped by truncating the stack;
+/// the entries of a popped scope are copied into a table of their own, which
+/// is all that later phases need. The table is frozen: a table pushed back as
+/// a scope is only looked up, so that the back ends can share it, and the
+/// entries in it keep their addresses.
 class SymbolManager
 {
 public:
-  using Table = std::unique_ptr<SymbolTable>;
+  /// @brief `nullptr` for a scope without symbols.
+  using Table = std::shared_ptr<const SymbolTable>;
 
 private:
-  std::vector<Table> m_tables;
+  struct Scope
+  {
+    /// @brief Where the entries of the scope begin in `m_entries`.
+    size_t m_begin;
+    /// @brief Set if the scope is pushed as a table, which holds its entries;
+    /// no symbol can be added to the scope then.
+    Table m_table;
+  };
+
+  /// @brief A deque, so that the entries of the scopes still open do not move
+  /// as more are pushed.
+  std::deque<SymbolEntry> m_entries;
+  std::vector<Scope> m_scopes;
 
   const bool m_opt_dmp;
 
@@ -136,7 +158,7 @@ public:
   // initial construction
   void pushScope();
   Table popScope();
-  /// @brief Pushes the given table as the new scope.
+  /// @brief Pushes the given table as the new scope, which is only looked up.
   void pushScope(Table p_table);
 
   /// @tparam AttributeType `Constant` or `FunctionNode::DeclNodes`
@@ -155,8 +177,9 @@ public:
   /// @return `nullptr` if not found.
   const SymbolEntry *lookup(const std::string &p_name) const;
 
-  /// @return `nullptr` if no scope is pushed.
-  const SymbolTable *getCurrentTable() const;
+  /// @brief Looks up the symbol in the current scope only.
+  /// @return `nullptr` if not found or no scope is pushed.
+  const SymbolEntry *lookupInCurrentScope(const std::string &p_name) const;
 
   /// @note Overflows if no scope is pushed.
   size_t getCurrentLevel() const;
@@ -0,0 +1,62 @@
+#ifndef UTIL_COMPILE_SERVER_HPP
+#define UTIL_COMPILE_SERVER_HPP
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// @brief A compile request read from a client of the `--server` mode.
+struct CompileRequest {
+  /// @brief The path of the source file; it names the output even if the
+  /// source is sent as text.
+  std::string m_source_path;
+  /// @brief The source text; if empty, the source is read from the path.
+  std::string m_source_text;
+  bool m_has_source_text{false};
+  std::string m_save_path;
+  /// @brief The options given on the command line, e.g., `--gc-functions`.
+  std::vector<std::string> m_flags;
+};
+
+/// @brief Serves compile requests on a Unix domain socket, one connection per
+/// request.
+///
+/// A request is a sequence of lines ending with an empty line:
+///
+///     source <path>
+///     text <path> <length>            (followed by <length> bytes of source
+///                                      text, at most 16 MiB)
+///     save-path <directory>
+///     flag <option> [<argument>...]   (may repeat)
+///
+/// The server has been started up once already when a request arrives; each
+/// request is compiled in a child forked from it, so that the state the
+/// scanner and the parser keep in globals starts afresh, while the
+/// initialization of the process (and of the sanitizer runtime) is shared.
+/// Everything the compiler prints is sent back, followed by a line
+///
+///     status <exit status> latency-us <microseconds>
+class CompileServer {
+ public:
+  /// @brief Compiles the request with `stdout` and `stderr` going to the
+  /// client; returns the exit status.
+  using Compile = std::function<int(const CompileRequest &)>;
+
+  CompileServer(const std::string &p_socket_path, Compile p_compile)
+      : m_socket_path{p_socket_path}, m_compile{std::move(p_compile)} {}
+
+  /// @brief Serves requests until the process is terminated.
+  /// @return A non-zero status if the socket cannot be set up.
+  int run();
+
+ private:
+  std::string m_socket_path;
+  Compile m_compile;
+
+  /// @return `false` if the request is malformed.
+  static bool readRequest(FILE *p_in, CompileRequest &p_request);
+  void serve(int p_connection);
+};
+
+#endif  // UTIL_COMPILE_SERVER_HPP
@@ -0,0 +1,148 @@
+#ifndef UTIL_HAND_LEXER_HPP
+#define UTIL_HAND_LEXER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "util/LineIndex.hpp"
+
+/// @brief A hand-written alternative to the flex scanner that splits the
+/// source into the same tokens.
+///
+/// The whole input is read into memory and indexed by line up front.
+/// Whitespace and comments are skipped 16 bytes at a time with SSE2 where
+/// available without looking for newlines; the lines a skip has passed are
+/// looked up in the index once the next token or comment starts. Keywords are
+/// told from identifiers by a perfect hash, and the column of a token is
+/// computed from the start of its line.
+///
+/// The lexer knows nothing about the parser; `scanner.l` maps the tokens to
+/// the ones of bison and lists them.
+class HandLexer {
+ public:
+  enum class TokenKind : uint8_t {
+    // Tokens with a fixed spelling.
+    kComma,
+    kSemicolon,
+    kColon,
+    kLParenthesis,
+    kRParenthesis,
+    kLBracket,
+    kRBracket,
+    kPlus,
+    kMinus,
+    kMultiply,
+    kDivide,
+    kAssign,
+    kLess,
+    kLessOrEqual,
+    kNotEqual,
+    kGreaterOrEqual,
+    kGreater,
+    kEqual,
+    // Keywords, including the operators `mod`, `and`, `or` and `not`.
+    kKwMod,
+    kKwAnd,
+    kKwOr,
+    kKwNot,
+    kKwVar,
+    kKwArray,
+    kKwOf,
+    kKwBoolean,
+    kKwInteger,
+    kKwReal,
+    kKwString,
+    kKwTrue,
+    kKwFalse,
+    kKwDef,
+    kKwReturn,
+    kKwBegin,
+    kKwEnd,
+    kKwWhile,
+    kKwDo,
+    kKwIf,
+    kKwThen,
+    kKwElse,
+    kKwFor,
+    kKwTo,
+    kKwPrint,
+    kKwRead,
+
+    kIdentifier,
+    kIntegerLiteral,
+    kOctIntegerLiteral,
+    kFloatLiteral,
+    kScientificLiteral,
+    /// @brief The text includes the quotes; a `""` inside stands for `"`.
+    kStringLiteral,
+    /// @brief A `//&[STD][+-]` comment, which turns a listing option on or off.
+    kPseudocomment,
+    /// @brief A character that starts no token; the text is that character.
+    kBadCharacter,
+    kEndOfInput
+  };
+
+  struct Token {
+    TokenKind m_kind;
+    /// @note Points into the buffer of the lexer; it is not null-terminated.
+    const char *m_text;
+    size_t m_length;
+    uint32_t m_line;
+    /// @brief One-based, in bytes.
+    uint32_t m_column;
+  };
+
+  /// @brief Called with the text of each line, without the newline, as soon
+  /// as its newline is skipped; `p_in_comment` tells whether the newline is
+  /// inside a `/* */` comment. A last line that does not end with a newline
+  /// is passed at the end of the input.
+  using LineCallback = std::function<void(
+      uint32_t p_line, const char *p_text, size_t p_length, bool p_in_comment)>;
+
+  /// @return `nullptr` if `p_in` cannot be read.
+  static std::unique_ptr<HandLexer> create(FILE *p_in,
+                                           LineCallback p_on_line);
+
+  /// @brief Comments are skipped except for pseudocomments. Once the input
+  /// is exhausted, every call returns `kEndOfInput`.
+  Token next();
+
+  /// @return The line of the last token, up to the end of that token.
+  const char *getLineBegin() const { return m_line_start; }
+  size_t getLineLength() const { return m_cursor - m_line_start; }
+
+ private:
+  /// @brief The buffer is padded with this many null bytes, so that a
+  /// 16-byte load starting before the end of the input stays inside it.
+  static constexpr size_t kPadding = 16;
+
+  std::vector<char> m_buffer;
+  std::unique_ptr<LineIndex> m_line_index;
+  const char *m_end{nullptr};
+  const char *m_cursor{nullptr};
+  const char *m_line_start{nullptr};
+  /// @brief Past the end if the current line is the last one.
+  const char *m_next_line_start{nullptr};
+  uint32_t m_line{1};
+  LineCallback m_on_line;
+
+  explicit HandLexer(LineCallback p_on_line)
+      : m_on_line{std::move(p_on_line)} {}
+
+  Token makeToken(TokenKind p_kind, const char *p_begin, size_t p_length);
+  /// @brief Passes on the lines whose newlines are before `p_pos`.
+  void endLines(const char *p_pos, bool p_in_comment);
+  const char *skipWhitespace(const char *p_pos);
+  /// @return The position right after the `*/`, or the end of the input.
+  const char *skipBlockComment(const char *p_pos);
+  size_t scanNumber(const char *p_begin, TokenKind &p_kind) const;
+  /// @return 0 if the string is not terminated on its line.
+  size_t scanString(const char *p_begin) const;
+  static TokenKind lookUpKeyword(const char *p_text, size_t p_length);
+};
+
+#endif  // UTIL_HAND_LEXER_HPP
@@ -0,0 +1,41 @@
+#ifndef UTIL_LINE_INDEX_HPP
+#define UTIL_LINE_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief The offsets at which the lines of a text start, found in one pass
+/// over the text that compares 32 (AVX2) or 16 (SSE2) bytes at a time.
+///
+/// Lines are one-based. The text after the last newline is a line of its own,
+/// which is empty if the text ends with a newline.
+class LineIndex {
+ public:
+  LineIndex(const char *p_text, size_t p_size);
+
+  uint32_t getNumLines() const {
+    return static_cast<uint32_t>(m_line_offsets.size());
+  }
+
+  size_t getLineOffset(uint32_t p_line) const {
+    return m_line_offsets[p_line - 1];
+  }
+
+  /// @return The length of the line without its newline.
+  size_t getLineLength(uint32_t p_line) const {
+    return (hasNewline(p_line) ? m_line_offsets[p_line] - 1 : m_size) -
+           m_line_offsets[p_line - 1];
+  }
+
+  /// @return `false` only for the last line.
+  bool hasNewline(uint32_t p_line) const {
+    return p_line < m_line_offsets.size();
+  }
+
+ private:
+  std::vector<size_t> m_line_offsets;
+  size_t m_size;
+};
+
+#endif  // UTIL_LINE_INDEX_HPP
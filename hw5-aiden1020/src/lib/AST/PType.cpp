@@ -2,11 +2,12 @@
 
 #include <cstddef>
 
-const char *kTypeString[] = {"void", "integer", "real", "boolean", "string"};
+const char *kTypeString[] = {"void", "integer", "real", "boolean", "string",
+                             "error"};
 
 // logical constness
 const char *PType::getPTypeCString() const {
-    if (!m_type_string_is_valid) {
+    std::call_once(m_type_string_once, [this]() {
         m_type_string += kTypeString[static_cast<size_t>(m_type)];
 
         if (m_dimensions.size() != 0) {
@@ -16,8 +17,7 @@ const char *PType::getPTypeCString() const {
                 m_type_string += "[" + std::to_string(dim) + "]";
             }
         }
-        m_type_string_is_valid = true;
-    }
+    });
 
     return m_type_string.c_str();
 }
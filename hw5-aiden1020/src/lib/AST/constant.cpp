@@ -4,7 +4,7 @@ static const char *kTFString[] = {"false", "true"};
 
 // logical constness
 const char *Constant::getConstantValueCString() const {
-    if (!m_constant_value_string_is_valid) {
+    std::call_once(m_constant_value_string_once, [this]() {
         switch (m_type->getPrimitiveType()) {
         case PType::PrimitiveTypeEnum::kIntegerType:
             m_constant_value_string = std::to_string(m_value.integer);
@@ -22,7 +22,6 @@ const char *Constant::getConstantValueCString() const {
         default:
             break;
         }
-        m_constant_value_string_is_valid = true;
-    }
+    });
     return m_constant_value_string.c_str();
 }
@@ -3,24 +3,39 @@
 #include "AST/function.hpp"
 #include "AST/program.hpp"
 #include "codegen/CodeGenerator.hpp"
+#include "codegen/DeadStoreAnalyzer.hpp"
+#include "codegen/FunctionHasher.hpp"
+#include "codegen/InlineAnalyzer.hpp"
+#include "codegen/LocalValueNumbering.hpp"
+#include "codegen/LoopInvariantAnalyzer.hpp"
 #include "sema/SemanticAnalyzer.hpp"
 #include "sema/SymbolTable.hpp"
 #include "visitor/AstNodeInclude.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <cinttypes>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
 
+// The Makefile sets it to a checksum of the sources of the code generator; a
+// build without it can only tell itself apart by the time it was compiled.
+#ifndef CODEGEN_BUILD_ID
+#define CODEGEN_BUILD_ID __DATE__ " " __TIME__
+#endif
+
 CodeGenerator::CodeGenerator(const std::string &source_file_name,
                              const std::string &save_path,
                              std::unordered_map<SemanticAnalyzer::AstNodeAddr,
                                                 SymbolManager::Table>
-                                 &&p_symbol_table_of_scoping_nodes)
+                                 p_symbol_table_of_scoping_nodes)
     : m_symbol_manager(false /* no dump */),
       m_source_file_path(source_file_name),
       m_symbol_table_of_scoping_nodes(std::move(p_symbol_table_of_scoping_nodes))
@@ -54,6 +69,785 @@ static void dumpInstructions(FILE *p_out_file, const char *format, ...)
     va_end(args);
 }
 
+// Range of the signed 12-bit immediate field of I-type instructions.
+static bool isImm12(int64_t p_value)
+{
+    return p_value >= -2048 && p_value <= 2047;
+}
+
+/// @return `nullptr` if the expression is not an integer or boolean constant.
+static const ConstantValueNode *asImmediateOperand(const ExpressionNode &p_expr)
+{
+    const auto *constant = dynamic_cast<const ConstantValueNode *>(&p_expr);
+    if (constant && (constant->getTypePtr()->isInteger() ||
+                     constant->getTypePtr()->isBool()))
+    {
+        return constant;
+    }
+    return nullptr;
+}
+
+static int64_t immediateValueOf(const ConstantValueNode &p_constant)
+{
+    if (p_constant.getTypePtr()->isBool())
+        return p_constant.getConstantPtr()->boolean() ? 1 : 0;
+    // Integer literals are 32-bit; wrap the same way the hardware does.
+    return static_cast<int32_t>(p_constant.getConstantPtr()->integer());
+}
+
+static bool isCommutative(Operator p_op)
+{
+    return p_op == Operator::kPlusOp || p_op == Operator::kMultiplyOp ||
+           p_op == Operator::kAndOp || p_op == Operator::kOrOp ||
+           p_op == Operator::kEqualOp || p_op == Operator::kNotEqualOp;
+}
+
+/// @return The distance in bytes between consecutive values of the `p_index`-th
+/// index of an array; every element takes 4 bytes.
+static int64_t strideOf(const std::vector<uint64_t> &p_dimensions, size_t p_index)
+{
+    int64_t stride = 4;
+    for (size_t i = p_index + 1; i < p_dimensions.size(); ++i)
+        stride *= p_dimensions[i];
+    return stride;
+}
+
+/// @return The number of bytes an array takes, or 4 for a scalar.
+static int64_t arraySizeOf(const std::vector<uint64_t> &p_dimensions)
+{
+    int64_t size = 4;
+    for (const uint64_t dimension : p_dimensions)
+        size *= dimension;
+    return size;
+}
+
+static bool isRealExpression(const ExpressionNode &p_expr)
+{
+    return p_expr.getInferredType() && p_expr.getInferredType()->isReal();
+}
+
+/// @return Whether the operands are combined or compared as reals; the other
+/// one is converted if it is an integer.
+static bool isRealOperation(const BinaryOperatorNode &p_bin_op)
+{
+    return isRealExpression(p_bin_op.getLeftOperand()) ||
+           isRealExpression(p_bin_op.getRightOperand());
+}
+
+/// @return The IEEE 754 single-precision encoding of the value; reals are
+/// 32-bit floats in RV32.
+static uint32_t floatBitsOf(double p_value)
+{
+    const float value = static_cast<float>(p_value);
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static std::vector<const PType *> parameterTypesOf(const FunctionNode::DeclNodes &p_parameters)
+{
+    std::vector<const PType *> types;
+    for (const auto &decl_node : p_parameters)
+        for (const auto &variable : decl_node->getVariables())
+            types.push_back(variable->getTypePtr());
+    return types;
+}
+
+/// @return The register each argument is passed in under the ILP32D calling
+/// convention: reals take fa0-fa7 and then any free integer register, others
+/// take a0-a7. An empty string means that the argument goes on the stack.
+static std::vector<std::string> argumentRegistersOf(const std::vector<const PType *> &p_types)
+{
+    std::vector<std::string> registers;
+    int num_int_registers = 0;
+    int num_float_registers = 0;
+    for (const auto *type : p_types)
+    {
+        if (type->isReal() && num_float_registers < 8)
+            registers.push_back("fa" + std::to_string(num_float_registers++));
+        else if (num_int_registers < 8)
+            registers.push_back("a" + std::to_string(num_int_registers++));
+        else
+            registers.push_back("");
+    }
+    return registers;
+}
+
+static bool isStringExpression(const ExpressionNode &p_expr)
+{
+    return p_expr.getInferredType() && p_expr.getInferredType()->isString();
+}
+
+/// @return The string quoted for a `.string` directive.
+static std::string quoteAssemblyString(const std::string &p_string)
+{
+    std::string quoted = "\"";
+    for (const char c : p_string)
+    {
+        switch (c)
+        {
+        case '"':
+            quoted += "\\\"";
+            break;
+        case '\\':
+            quoted += "\\\\";
+            break;
+        case '\n':
+            quoted += "\\n";
+            break;
+        case '\t':
+            quoted += "\\t";
+            break;
+        default:
+            quoted += c;
+            break;
+        }
+    }
+    return quoted + "\"";
+}
+
+static bool isFloatRegister(const std::string &p_reg)
+{
+    return p_reg[0] == 'f';
+}
+
+static bool isComparison(Operator p_op)
+{
+    switch (p_op)
+    {
+    case Operator::kLessOp:
+    case Operator::kLessOrEqualOp:
+    case Operator::kGreaterOp:
+    case Operator::kGreaterOrEqualOp:
+    case Operator::kEqualOp:
+    case Operator::kNotEqualOp:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @return The comparison that holds for `b op' a` whenever `a op b` holds.
+static Operator swapComparison(Operator p_op)
+{
+    switch (p_op)
+    {
+    case Operator::kLessOp:
+        return Operator::kGreaterOp;
+    case Operator::kLessOrEqualOp:
+        return Operator::kGreaterOrEqualOp;
+    case Operator::kGreaterOp:
+        return Operator::kLessOp;
+    case Operator::kGreaterOrEqualOp:
+        return Operator::kLessOrEqualOp;
+    default:
+        return p_op;
+    }
+}
+
+/// @return The branch taken when `lhs op rhs` holds, or when it does not hold
+/// if `p_negate` is set.
+static const char *branchMnemonicOf(Operator p_op, bool p_negate)
+{
+    switch (p_op)
+    {
+    case Operator::kLessOp:
+        return p_negate ? "bge" : "blt";
+    case Operator::kLessOrEqualOp:
+        return p_negate ? "bgt" : "ble";
+    case Operator::kGreaterOp:
+        return p_negate ? "ble" : "bgt";
+    case Operator::kGreaterOrEqualOp:
+        return p_negate ? "blt" : "bge";
+    case Operator::kEqualOp:
+        return p_negate ? "bne" : "beq";
+    case Operator::kNotEqualOp:
+        return p_negate ? "beq" : "bne";
+    default:
+        assert(false && "Not a comparison");
+        return nullptr;
+    }
+}
+
+/// @return Whether control never flows past the statement, i.e., it returns on
+/// every path.
+static bool alwaysReturns(const AstNode &p_statement)
+{
+    if (dynamic_cast<const ReturnNode *>(&p_statement))
+        return true;
+    if (const auto *block = dynamic_cast<const CompoundStatementNode *>(&p_statement))
+    {
+        const auto &statements = block->getStatements();
+        return std::any_of(statements.begin(), statements.end(),
+                           [](const auto &statement)
+                           { return alwaysReturns(*statement); });
+    }
+    if (const auto *if_node = dynamic_cast<const IfNode *>(&p_statement))
+        return if_node->getElseBody() && alwaysReturns(*if_node->getBody()) &&
+               alwaysReturns(*if_node->getElseBody());
+    return false;
+}
+
+void CodeGenerator::emitLoadImmediate(const char *p_reg, int64_t p_value)
+{
+    const int32_t value = static_cast<int32_t>(p_value);
+    if (isImm12(value))
+    {
+        dumpInstructions(m_output_file.get(), "    li %s, %d\n", p_reg, value);
+        return;
+    }
+    // `addi` sign-extends its immediate, so round the upper part up when the
+    // lower 12 bits are negative.
+    const uint32_t hi = ((static_cast<uint32_t>(value) + 0x800) >> 12) & 0xfffff;
+    const int32_t lo = static_cast<int32_t>(static_cast<uint32_t>(value) - (hi << 12));
+    dumpInstructions(m_output_file.get(), "    lui %s, %u\n", p_reg, hi);
+    if (lo != 0)
+        dumpInstructions(m_output_file.get(), "    addi %s, %s, %d\n", p_reg, p_reg, lo);
+}
+
+bool CodeGenerator::emitImmediateBinaryOp(Operator p_op, int64_t p_imm)
+{
+    FILE *out = m_output_file.get();
+    switch (p_op)
+    {
+    case Operator::kPlusOp:
+        if (!isImm12(p_imm))
+            return false;
+        dumpInstructions(out, "    addi t0, t1, %d\n", int(p_imm));
+        return true;
+    case Operator::kMinusOp:
+        if (!isImm12(-p_imm))
+            return false;
+        dumpInstructions(out, "    addi t0, t1, %d\n", int(-p_imm));
+        return true;
+    case Operator::kAndOp:
+        dumpInstructions(out, "    andi t0, t1, %d\n", int(p_imm));
+        return true;
+    case Operator::kOrOp:
+        dumpInstructions(out, "    ori t0, t1, %d\n", int(p_imm));
+        return true;
+    default:
+        break;
+    }
+
+    if (!isImm12(p_imm))
+        return false;
+    switch (p_op)
+    {
+    case Operator::kLessOp:
+        dumpInstructions(out, "    slti t0, t1, %d\n", int(p_imm));
+        return true;
+    case Operator::kGreaterOrEqualOp:
+        dumpInstructions(out, "    slti t0, t1, %d\n"
+                              "    xori t0, t0, 1\n",
+                         int(p_imm));
+        return true;
+    case Operator::kLessOrEqualOp:
+        if (!isImm12(p_imm + 1))
+            return false;
+        dumpInstructions(out, "    slti t0, t1, %d\n", int(p_imm + 1));
+        return true;
+    case Operator::kGreaterOp:
+        if (!isImm12(p_imm + 1))
+            return false;
+        dumpInstructions(out, "    slti t0, t1, %d\n"
+                              "    xori t0, t0, 1\n",
+                         int(p_imm + 1));
+        return true;
+    case Operator::kEqualOp:
+        if (p_imm != 0)
+            dumpInstructions(out, "    xori t0, t1, %d\n"
+                                  "    seqz t0, t0\n",
+                             int(p_imm));
+        else
+            dumpInstructions(out, "    seqz t0, t1\n");
+        return true;
+    case Operator::kNotEqualOp:
+        if (p_imm != 0)
+            dumpInstructions(out, "    xori t0, t1, %d\n"
+                                  "    snez t0, t0\n",
+                             int(p_imm));
+        else
+            dumpInstructions(out, "    snez t0, t1\n");
+        return true;
+    default:
+        return false;
+    }
+}
+
+void CodeGenerator::enterScope(const AstNode &p_node)
+{
+    m_symbol_manager.pushScope(m_symbol_table_of_scoping_nodes.at(&p_node));
+}
+
+void CodeGenerator::leaveScope(const AstNode &p_node)
+{
+    m_symbol_manager.popScope();
+}
+
+bool CodeGenerator::emitInlinedCall(FunctionInvocationNode &p_func_invocation)
+{
+    const FunctionNode *callee = m_inline_analyzer.getInlineTarget(p_func_invocation.getName());
+    if (!callee)
+        return false;
+
+    // The arguments are evaluated in the scope of the caller.
+    const auto parameter_types = parameterTypesOf(callee->getParameters());
+    const auto &arguments = p_func_invocation.getArguments();
+    m_is_in_function_invocation = true;
+    for (size_t i = 0; i < arguments.size(); ++i)
+        visitCoerced(*arguments[i], parameter_types[i]);
+    m_is_in_function_invocation = false;
+
+    // The callee only sees the globals and its own symbols.
+    std::vector<SymbolManager::Table> caller_scopes;
+    while (m_symbol_manager.getCurrentLevel() > 0)
+        caller_scopes.push_back(m_symbol_manager.popScope());
+    enterScope(*callee);
+
+    std::vector<const SymbolEntry *> parameters;
+    for (const auto &decl_node : callee->getParameters())
+        for (const auto &variable : decl_node->getVariables())
+            parameters.push_back(m_symbol_manager.lookup(variable->getName()));
+    for (auto it = parameters.rbegin(); it != parameters.rend(); ++it)
+    {
+        m_frame_offsets[*it] = allocateFrameSlot();
+        dumpInstructions(m_output_file.get(), "    lw t0, 0(sp)\n"
+                                              "    addi sp, sp, 4\n"
+                                              "    sw t0, %d(s0)\n",
+                         getFrameOffset(**it));
+    }
+
+    // A `return` in an inlined body leaves its value on the stack as if the
+    // call had pushed `a0`.
+    DeadStoreAnalyzer callee_stores;
+    callee_stores.analyze(const_cast<CompoundStatementNode &>(*callee->getBody()));
+    std::swap(m_dead_stores, callee_stores);
+    const PType *caller_return_type = m_return_type;
+    m_return_type = callee->getTypePtr();
+    ++m_inline_depth;
+    const_cast<FunctionNode *>(callee)->visitBodyChildNodes(*this);
+    --m_inline_depth;
+    m_return_type = caller_return_type;
+    std::swap(m_dead_stores, callee_stores);
+
+    leaveScope(*callee);
+    while (!caller_scopes.empty())
+    {
+        m_symbol_manager.pushScope(std::move(caller_scopes.back()));
+        caller_scopes.pop_back();
+    }
+
+    if (m_report_inlining)
+        fprintf(stderr, "%s:%u:%u: inlined '%s' (size %zu) into '%s'\n",
+                m_source_file_path.c_str(), p_func_invocation.getLocation().line,
+                p_func_invocation.getLocation().col, callee->getNameCString(),
+                m_inline_analyzer.getSize(callee->getName()),
+                m_current_function_name.c_str());
+    return true;
+}
+
+bool CodeGenerator::isDeadStore(const VariableReferenceNode &p_lvalue) const
+{
+    const SymbolEntry *entry = p_lvalue.getSymbolEntry();
+    return entry && entry->getLevel() != 0 && p_lvalue.getIndices().empty() &&
+           entry->getKind() != SymbolEntry::KindEnum::kLoopVarKind &&
+           !m_dead_stores.isRead(p_lvalue.getName());
+}
+
+int CodeGenerator::allocateFrameSlot()
+{
+    m_current_offset -= 4;
+    return m_current_offset;
+}
+
+void CodeGenerator::beginFunctionBody(const bool p_saves_s1)
+{
+    assert(!m_function_output_file && "Function bodies cannot be nested");
+    m_saves_s1 = p_saves_s1;
+    // Labels are local to the function, so that its code does not depend on
+    // the functions emitted before it.
+    m_label_prefix = ".L" + m_current_function_name + ".";
+    m_label_count = 1;
+    m_current_offset = p_saves_s1 ? -12 : -8;
+    m_cse_slots.clear();
+    m_cse_slots_in_use = 0;
+    m_function_output_file = std::move(m_output_file);
+    m_output_file.reset(open_memstream(&m_function_body, &m_function_body_size));
+    assert(m_output_file.get() && "Failed to open the function body buffer");
+}
+
+void CodeGenerator::endFunctionBody()
+{
+    // Flushes the buffer and updates `m_function_body_size`.
+    m_output_file = std::move(m_function_output_file);
+
+    // ra, s0 (and s1) take the first slots; keep sp 16-byte aligned.
+    const int frame_size = (-m_current_offset + 15) & ~15;
+    if (isImm12(frame_size))
+    {
+        dumpInstructions(m_output_file.get(), "    addi sp, sp, -%d\n"
+                                              "    sw ra, %d(sp)\n"
+                                              "    sw s0, %d(sp)\n",
+                         frame_size, frame_size - 4, frame_size - 8);
+        if (m_saves_s1)
+            dumpInstructions(m_output_file.get(), "    sw s1, %d(sp)\n", frame_size - 12);
+        dumpInstructions(m_output_file.get(), "    addi s0, sp, %d\n\n", frame_size);
+    }
+    else
+    {
+        dumpInstructions(m_output_file.get(), "    sw ra, -4(sp)\n"
+                                              "    sw s0, -8(sp)\n");
+        if (m_saves_s1)
+            dumpInstructions(m_output_file.get(), "    sw s1, -12(sp)\n");
+        dumpInstructions(m_output_file.get(), "    mv s0, sp\n");
+        emitLoadImmediate("t0", frame_size);
+        dumpInstructions(m_output_file.get(), "    sub sp, sp, t0\n\n");
+    }
+    fwrite(m_function_body, 1, m_function_body_size, m_output_file.get());
+    free(m_function_body);
+    m_function_body = nullptr;
+    m_function_body_size = 0;
+}
+
+void CodeGenerator::emitFrameTeardown()
+{
+    dumpInstructions(m_output_file.get(), "    lw ra, -4(s0)\n");
+    if (m_saves_s1)
+        dumpInstructions(m_output_file.get(), "    lw s1, -12(s0)\n");
+    dumpInstructions(m_output_file.get(), "    mv sp, s0\n"
+                                          "    lw s0, -8(sp)\n");
+}
+
+void CodeGenerator::emitRuntimeCall(const char *p_routine)
+{
+    dumpInstructions(m_output_file.get(), "    mv s1, sp\n"
+                                          "    andi sp, sp, -16\n"
+                                          "    jal ra, %s\n"
+                                          "    mv sp, s1\n",
+                     p_routine);
+}
+
+void CodeGenerator::emitArrayBase(const SymbolEntry &p_entry)
+{
+    if (p_entry.getLevel() == 0)
+        emitGlobalAddress("t0", p_entry.getNameCString());
+    else if (p_entry.getKind() == SymbolEntry::KindEnum::kParameterKind)
+        // Arrays are passed by address.
+        dumpInstructions(m_output_file.get(), "    lw t0, %d(s0)\n", getFrameOffset(p_entry));
+    else
+        dumpInstructions(m_output_file.get(), "    addi t0, s0, %d\n", getFrameOffset(p_entry));
+}
+
+void CodeGenerator::emitElementAddress(const VariableReferenceNode &p_ref,
+                                       const SymbolEntry &p_entry)
+{
+    constexpr const char *const riscv_assembly_push = "    addi sp, sp, -4\n"
+                                                      "    sw t0, 0(sp)\n";
+    constexpr const char *const riscv_assembly_pop = "    lw t0, 0(sp)\n"
+                                                     "    addi sp, sp, 4\n";
+
+    // Indices are values even if the element is being assigned or read into.
+    const bool assign_left = m_assign_left;
+    const bool is_in_read = m_is_in_read;
+    m_assign_left = false;
+    m_is_in_read = false;
+
+    // Constant indices are folded into a single offset; the others are scaled
+    // and summed on the stack.
+    const auto &dimensions = p_entry.getTypePtr()->getDimensions();
+    const auto &indices = p_ref.getIndices();
+    int64_t constant_offset = 0;
+    bool has_variable_offset = false;
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        const int64_t stride = strideOf(dimensions, i);
+        if (const auto *immediate = asImmediateOperand(*indices[i]))
+        {
+            constant_offset += immediateValueOf(*immediate) * stride;
+            continue;
+        }
+
+        indices[i]->accept(*this);
+        dumpInstructions(m_output_file.get(), riscv_assembly_pop);
+        if ((stride & (stride - 1)) == 0)
+        {
+            int shift = 0;
+            while ((int64_t{1} << shift) < stride)
+                ++shift;
+            dumpInstructions(m_output_file.get(), "    slli t0, t0, %d\n", shift);
+        }
+        else
+        {
+            emitLoadImmediate("t1", stride);
+            dumpInstructions(m_output_file.get(), "    mul t0, t0, t1\n");
+        }
+        if (has_variable_offset)
+            dumpInstructions(m_output_file.get(), "    lw t1, 0(sp)\n"
+                                                  "    addi sp, sp, 4\n"
+                                                  "    add t0, t1, t0\n");
+        dumpInstructions(m_output_file.get(), riscv_assembly_push);
+        has_variable_offset = true;
+    }
+    m_assign_left = assign_left;
+    m_is_in_read = is_in_read;
+
+    emitArrayBase(p_entry);
+    if (has_variable_offset)
+        dumpInstructions(m_output_file.get(), "    lw t1, 0(sp)\n"
+                                              "    addi sp, sp, 4\n"
+                                              "    add t0, t0, t1\n");
+    if (constant_offset != 0)
+    {
+        if (isImm12(constant_offset))
+            dumpInstructions(m_output_file.get(), "    addi t0, t0, %d\n", int(constant_offset));
+        else
+        {
+            emitLoadImmediate("t1", constant_offset);
+            dumpInstructions(m_output_file.get(), "    add t0, t0, t1\n");
+        }
+    }
+    dumpInstructions(m_output_file.get(), riscv_assembly_push);
+}
+
+void CodeGenerator::emitGlobalAddress(const char *p_reg, const char *p_name)
+{
+    auto hoisted = m_hoisted_address_offsets.find(p_name);
+    if (hoisted != m_hoisted_address_offsets.end())
+        dumpInstructions(m_output_file.get(), "    lw %s, %d(s0)\n", p_reg, hoisted->second);
+    else
+        dumpInstructions(m_output_file.get(), "    la %s, %s\n", p_reg, p_name);
+}
+
+void CodeGenerator::emitLoopPreheader(AstNode &p_loop, LoopPreheader &p_preheader)
+{
+    LoopInvariantAnalyzer analyzer;
+    analyzer.analyze(p_loop);
+
+    for (const auto &name : analyzer.getReferencedGlobals())
+    {
+        if (m_hoisted_address_offsets.count(name))
+            continue;
+        const int offset = allocateFrameSlot();
+        dumpInstructions(m_output_file.get(), "    la t0, %s\n"
+                                              "    sw t0, %d(s0)\n",
+                         name.c_str(), offset);
+        m_hoisted_address_offsets[name] = offset;
+        p_preheader.m_globals.push_back(name);
+    }
+
+    for (auto *expr : analyzer.getInvariantExpressions())
+    {
+        if (m_hoisted_expr_offsets.count(expr))
+            continue;
+        const_cast<ExpressionNode *>(expr)->accept(*this);
+
+        const int offset = allocateFrameSlot();
+        dumpInstructions(m_output_file.get(), "    lw t0, 0(sp)\n"
+                                              "    addi sp, sp, 4\n"
+                                              "    sw t0, %d(s0)\n",
+                         offset);
+        m_hoisted_expr_offsets[expr] = offset;
+        p_preheader.m_exprs.push_back(expr);
+    }
+
+    // The loop variable holds its lower bound here, so this is the address of
+    // the element accessed in the first iteration.
+    for (auto *ref : analyzer.getInductionReferences())
+    {
+        const SymbolEntry *entry = ref->getSymbolEntry();
+        if (!entry || m_induction_ref_offsets.count(ref))
+            continue;
+        emitElementAddress(*ref, *entry);
+
+        const int offset = allocateFrameSlot();
+        dumpInstructions(m_output_file.get(), "    lw t0, 0(sp)\n"
+                                              "    addi sp, sp, 4\n"
+                                              "    sw t0, %d(s0)\n",
+                         offset);
+        m_induction_ref_offsets[ref] = offset;
+        p_preheader.m_induction_refs.push_back(ref);
+    }
+}
+
+void CodeGenerator::emitInductionStep(const LoopPreheader &p_preheader)
+{
+    for (const auto *ref : p_preheader.m_induction_refs)
+    {
+        const SymbolEntry *entry = ref->getSymbolEntry();
+        const auto &dimensions = entry->getTypePtr()->getDimensions();
+        const int64_t stride = strideOf(dimensions, ref->getIndices().size() - 1);
+        const int offset = m_induction_ref_offsets.at(ref);
+        dumpInstructions(m_output_file.get(), "    lw t0, %d(s0)\n", offset);
+        if (isImm12(stride))
+            dumpInstructions(m_output_file.get(), "    addi t0, t0, %d\n", int(stride));
+        else
+        {
+            emitLoadImmediate("t1", stride);
+            dumpInstructions(m_output_file.get(), "    add t0, t0, t1\n");
+        }
+        dumpInstructions(m_output_file.get(), "    sw t0, %d(s0)\n", offset);
+    }
+}
+
+void CodeGenerator::dropHoistedValues(const LoopPreheader &p_preheader)
+{
+    for (const auto *expr : p_preheader.m_exprs)
+        m_hoisted_expr_offsets.erase(expr);
+    for (const auto &name : p_preheader.m_globals)
+        m_hoisted_address_offsets.erase(name);
+    for (const auto *ref : p_preheader.m_induction_refs)
+        m_induction_ref_offsets.erase(ref);
+}
+
+bool CodeGenerator::pushHoistedValue(const ExpressionNode &p_expr)
+{
+    auto hoisted = m_hoisted_expr_offsets.find(&p_expr);
+    if (hoisted == m_hoisted_expr_offsets.end())
+        return false;
+    dumpInstructions(m_output_file.get(), "    lw t0, %d(s0)\n"
+                                          "    addi sp, sp, -4\n"
+                                          "    sw t0, 0(sp)\n",
+                     hoisted->second);
+    return true;
+}
+
+void CodeGenerator::emitBranch(const char *p_mnemonic, const char *p_lhs,
+                               const char *p_rhs, int p_true_label,
+                               int p_false_label)
+{
+    dumpInstructions(m_output_file.get(), "    %s %s, %s, %s%d\n",
+                     p_mnemonic, p_lhs, p_rhs, m_label_prefix.c_str(), p_true_label);
+    if (p_false_label != 0)
+        dumpInstructions(m_output_file.get(), "    j %s%d\n", m_label_prefix.c_str(), p_false_label);
+}
+
+void CodeGenerator::genCondBranch(const ExpressionNode &p_cond, int p_true_label,
+                                  int p_false_label)
+{
+    assert((p_true_label != 0 || p_false_label != 0) &&
+           "A condition cannot fall through on both outcomes");
+    FILE *out = m_output_file.get();
+
+    auto branch_on_value = [&](const char *p_reg)
+    {
+        if (p_true_label != 0)
+            emitBranch("bne", p_reg, "zero", p_true_label, p_false_label);
+        else
+            dumpInstructions(out, "    beqz %s, %s%d\n", p_reg, m_label_prefix.c_str(), p_false_label);
+    };
+    auto evaluate_and_branch = [&]()
+    {
+        const_cast<ExpressionNode &>(p_cond).accept(*this);
+        dumpInstructions(out, "    lw t0, 0(sp)\n"
+                              "    addi sp, sp, 4\n");
+        branch_on_value("t0");
+    };
+
+    // The value was computed in a loop preheader.
+    auto hoisted = m_hoisted_expr_offsets.find(&p_cond);
+    if (hoisted != m_hoisted_expr_offsets.end())
+    {
+        dumpInstructions(out, "    lw t0, %d(s0)\n", hoisted->second);
+        branch_on_value("t0");
+        return;
+    }
+
+    if (const auto *constant = asImmediateOperand(p_cond))
+    {
+        const int target = immediateValueOf(*constant) ? p_true_label : p_false_label;
+        if (target != 0)
+            dumpInstructions(out, "    j %s%d\n", m_label_prefix.c_str(), target);
+        return;
+    }
+
+    // A common subexpression has to be materialized, so that its value is
+    // saved for the later uses, which load it as if it were hoisted.
+    if (m_cse_save_offsets.count(&p_cond))
+    {
+        evaluate_and_branch();
+        return;
+    }
+
+    if (const auto *un_op = dynamic_cast<const UnaryOperatorNode *>(&p_cond))
+    {
+        if (un_op->getOp() == Operator::kNotOp)
+        {
+            genCondBranch(un_op->getOperand(), p_false_label, p_true_label);
+            return;
+        }
+    }
+
+    if (const auto *bin_op = dynamic_cast<const BinaryOperatorNode *>(&p_cond))
+    {
+        const Operator op = bin_op->getOp();
+        if (op == Operator::kAndOp)
+        {
+            // The right operand is only evaluated if the left one holds.
+            const int skip_label = p_false_label != 0 ? p_false_label : m_label_count++;
+            genCondBranch(bin_op->getLeftOperand(), 0, skip_label);
+            genCondBranch(bin_op->getRightOperand(), p_true_label, p_false_label);
+            if (p_false_label == 0)
+                dumpInstructions(out, "%s%d:\n", m_label_prefix.c_str(), skip_label);
+            return;
+        }
+        if (op == Operator::kOrOp)
+        {
+            // The right operand is only evaluated if the left one fails.
+            const int skip_label = p_true_label != 0 ? p_true_label : m_label_count++;
+            genCondBranch(bin_op->getLeftOperand(), skip_label, 0);
+            genCondBranch(bin_op->getRightOperand(), p_true_label, p_false_label);
+            if (p_true_label == 0)
+                dumpInstructions(out, "%s%d:\n", m_label_prefix.c_str(), skip_label);
+            return;
+        }
+        if (isComparison(op) && !isRealOperation(*bin_op))
+        {
+            // Compare the operands in registers and branch on the result,
+            // comparing against `zero` directly when possible.
+            Operator branch_op = op;
+            const ExpressionNode *variable_operand = &bin_op->getLeftOperand();
+            const ConstantValueNode *immediate = asImmediateOperand(bin_op->getRightOperand());
+            if (!immediate && (immediate = asImmediateOperand(bin_op->getLeftOperand())))
+            {
+                variable_operand = &bin_op->getRightOperand();
+                branch_op = swapComparison(op);
+            }
+
+            const char *rhs = "t0";
+            if (immediate)
+            {
+                const_cast<ExpressionNode *>(variable_operand)->accept(*this);
+                dumpInstructions(out, "    lw t1, 0(sp)\n"
+                                      "    addi sp, sp, 4\n");
+                if (immediateValueOf(*immediate) == 0)
+                    rhs = "zero";
+                else
+                    emitLoadImmediate("t0", immediateValueOf(*immediate));
+            }
+            else
+            {
+                const_cast<BinaryOperatorNode *>(bin_op)->visitChildNodes(*this);
+                dumpInstructions(out, "    lw t0, 0(sp)\n"
+                                      "    addi sp, sp, 4\n"
+                                      "    lw t1, 0(sp)\n"
+                                      "    addi sp, sp, 4\n");
+            }
+
+            if (p_true_label != 0)
+                emitBranch(branchMnemonicOf(branch_op, false), "t1", rhs,
+                           p_true_label, p_false_label);
+            else
+                emitBranch(branchMnemonicOf(branch_op, true), "t1", rhs,
+                           p_false_label, 0);
+            return;
+        }
+    }
+
+    // Any other boolean expression is evaluated and tested against zero.
+    evaluate_and_branch();
+}
+
 void CodeGenerator::visit(ProgramNode &p_program)
 {
     // Generate RISC-V instructions for program header
@@ -70,37 +864,53 @@ void CodeGenerator::visit(ProgramNode &p_program)
         "main:\n";
     constexpr const char *riscv_assembly_main_end =
         "    .size main, .-main\n";
-    constexpr const char *const riscv_assembly_prologue = "    addi sp, sp, -128\n"
-                                                      "    sw ra, 124(sp)\n"
-                                                      "    sw s0, 120(sp)\n"
-                                                      "    addi s0, sp, 128\n\n";
-    constexpr const char *const riscv_assembly_epilogue = "    lw ra, 124(sp)\n"
-                                                      "    lw s0, 120(sp)\n"
-                                                      "    addi sp, sp, 128\n"
-                                                      "    jr ra\n";
     // clang-format on
     dumpInstructions(m_output_file.get(), riscv_assembly_file_prologue,
                      m_source_file_path.c_str());
 
     // Reconstruct the scope for looking up the symbol entry.
     // Hint: Use m_symbol_manager->lookup(symbol_name) to get the symbol entry.
-    m_symbol_manager.pushScope(
-        std::move(m_symbol_table_of_scoping_nodes.at(&p_program)));
+    enterScope(p_program);
+    p_program.accept(m_inline_analyzer);
+    // The inlining report is printed while generating code.
+    if (m_report_inlining)
+        m_function_cache.reset();
+    if (m_function_cache)
+        computeFunctionCacheKeys(p_program);
 
     auto visit_ast_node = [&](auto &ast_node)
     { ast_node->accept(*this); };
+    if (m_prelude)
+        for_each(m_prelude->getDeclNodes().begin(), m_prelude->getDeclNodes().end(),
+                 visit_ast_node);
     for_each(p_program.getDeclNodes().begin(), p_program.getDeclNodes().end(),
              visit_ast_node);
-    for_each(p_program.getFuncNodes().begin(), p_program.getFuncNodes().end(),
-             visit_ast_node);
+    const auto live_functions = m_inline_analyzer.collectLiveFunctions(p_program.getName());
+    for (const auto &func_node : p_program.getFuncNodes())
+    {
+        if (m_gc_functions && m_emits_main && !live_functions.count(func_node->getName()))
+            continue;
+        func_node->accept(*this);
+    }
 
+    if (!m_emits_main)
+    {
+        emitConstantPool();
+        leaveScope(p_program);
+        return;
+    }
     dumpInstructions(m_output_file.get(), riscv_assembly_main_start);
-    dumpInstructions(m_output_file.get(), riscv_assembly_prologue);
+    m_current_function_name = "main";
+    beginFunctionBody(m_inline_analyzer.hasOutOfLineCall(p_program.getName()));
+    m_dead_stores.analyze(const_cast<CompoundStatementNode &>(p_program.getBody()));
     const_cast<CompoundStatementNode &>(p_program.getBody()).accept(*this);
-    dumpInstructions(m_output_file.get(), riscv_assembly_epilogue);
+    emitFrameTeardown();
+    dumpInstructions(m_output_file.get(), "    jr ra\n");
+    endFunctionBody();
     dumpInstructions(m_output_file.get(), riscv_assembly_main_end);
+    emitConstantPool();
 
-    m_symbol_manager.popScope();
+    leaveScope(p_program);
 }
 
 void CodeGenerator::visit(DeclNode &p_decl)
@@ -112,21 +922,21 @@ void CodeGenerator::visit(DeclNode &p_decl)
 
 void CodeGenerator::visit(VariableNode &p_variable)
 {
-    SymbolEntry *symbol_entry = const_cast<SymbolEntry *>(m_symbol_manager.lookup(p_variable.getName()));
+    const SymbolEntry *symbol_entry = m_symbol_manager.lookup(p_variable.getName());
     if (!symbol_entry)
         return;
 
     const char *variable_name = symbol_entry->getNameCString();
-    if (symbol_entry->getTypePtr()->getPrimitiveType() == PType::PrimitiveTypeEnum::kBoolType)
-        m_assign_bool = true;
     if (m_is_in_declaration)
     {
         if (symbol_entry->getLevel() == 0)
         { // Global Declaration
             if (p_variable.getConstantPtr() == nullptr)
             {
-                constexpr const char *const riscv_assembly_GlobalVarDecl = ".comm %s, 4, 4\n";
-                dumpInstructions(m_output_file.get(), riscv_assembly_GlobalVarDecl, variable_name);
+                constexpr const char *const riscv_assembly_GlobalVarDecl = ".comm %s, %lld, 4\n";
+                const auto &dimensions = symbol_entry->getTypePtr()->getDimensions();
+                dumpInstructions(m_output_file.get(), riscv_assembly_GlobalVarDecl, variable_name,
+                                 static_cast<long long>(arraySizeOf(dimensions)));
             }
             else
             {
@@ -135,32 +945,56 @@ void CodeGenerator::visit(VariableNode &p_variable)
                                                                              "    .globl %s\n"
                                                                              "    .type %s, @object\n%s:\n"
                                                                              "    .word %s\n";
+                // A string constant holds the address of its pooled literal.
+                const Constant *constant = p_variable.getConstantPtr();
+                std::string value = constant->getConstantValueCString();
+                if (constant->getTypePtr()->isReal())
+                    value = std::to_string(floatBitsOf(constant->real()));
+                else if (constant->getTypePtr()->isString())
+                    value = getStringConstantLabel(value);
                 dumpInstructions(m_output_file.get(), riscv_assembly_GlobalConstDecl,
                                  variable_name, variable_name,
-                                 variable_name, p_variable.getConstantPtr()->getConstantValueCString());
+                                 variable_name, value.c_str());
             }
         }
         else
         { // Local Declaration
-            m_current_offset -= 4;
-            symbol_entry->setOffset(m_current_offset);
             if (symbol_entry->getKind() == SymbolEntry::KindEnum::kParameterKind)
             {
-                constexpr const char *const riscv_assembly_local_var_a = "    sw a%d, %d(s0)\n";
-                constexpr const char *const riscv_assembly_local_var_t = "    sw t%d, %d(s0)\n";
-
-                if (m_parameter_count < 8)
+                // Arguments in registers are spilled to the frame; the rest are
+                // already in memory, in the caller's outgoing area right above
+                // our frame.
+                const auto &reg = m_parameter_registers[m_parameter_count];
+                if (!reg.empty())
                 {
-
-                    dumpInstructions(m_output_file.get(), riscv_assembly_local_var_a, m_parameter_count, m_current_offset);
+                    m_frame_offsets[symbol_entry] = allocateFrameSlot();
+                    dumpInstructions(m_output_file.get(), "    %s %s, %d(s0)\n",
+                                     isFloatRegister(reg) ? "fsw" : "sw", reg.c_str(),
+                                     getFrameOffset(*symbol_entry));
                 }
                 else
                 {
-                    dumpInstructions(m_output_file.get(), riscv_assembly_local_var_t, m_parameter_count % 8 + 2, m_current_offset);
+                    const auto num_stack_parameters =
+                        std::count(m_parameter_registers.begin(),
+                                   m_parameter_registers.begin() + m_parameter_count, "");
+                    m_frame_offsets[symbol_entry] = int(num_stack_parameters) * 4;
                 }
                 m_parameter_count++;
             }
-            else if (p_variable.getConstantPtr() != nullptr)
+            else if (!symbol_entry->getTypePtr()->getDimensions().empty())
+            {
+                // The elements are laid out upwards from the lowest address.
+                m_current_offset -= arraySizeOf(symbol_entry->getTypePtr()->getDimensions());
+                m_frame_offsets[symbol_entry] = m_current_offset;
+            }
+            else
+            {
+                m_frame_offsets[symbol_entry] = allocateFrameSlot();
+            }
+
+            if (symbol_entry->getKind() != SymbolEntry::KindEnum::kParameterKind &&
+                p_variable.getConstantPtr() != nullptr &&
+                m_dead_stores.isRead(p_variable.getName()))
             {
                 constexpr const char *const riscv_assembly_PushLocalAddress = "    addi t0, s0, %d\n"
                                                                               "    addi sp, sp, -4\n"
@@ -170,7 +1004,7 @@ void CodeGenerator::visit(VariableNode &p_variable)
                                                                                "    lw t1, 0(sp)\n"
                                                                                "    addi sp, sp, 4\n"
                                                                                "    sw t0, 0(t1)\n";
-                dumpInstructions(m_output_file.get(), riscv_assembly_PushLocalAddress, symbol_entry->getOffset());
+                dumpInstructions(m_output_file.get(), riscv_assembly_PushLocalAddress, getFrameOffset(*symbol_entry));
                 p_variable.visitChildNodes(*this);
                 dumpInstructions(m_output_file.get(), riscv_assembly_PerformAssignment);
             }
@@ -207,34 +1041,247 @@ void CodeGenerator::visit(VariableNode &p_variable)
                                                                         "    sw t0, 0(sp)\n";
             if (m_assign_left)
             {
-                dumpInstructions(m_output_file.get(), riscv_assembly_PushLocalAddress, symbol_entry->getOffset());
+                dumpInstructions(m_output_file.get(), riscv_assembly_PushLocalAddress, getFrameOffset(*symbol_entry));
             }
             else
             {
-                dumpInstructions(m_output_file.get(), riscv_assembly_PushLocalValue, symbol_entry->getOffset());
+                dumpInstructions(m_output_file.get(), riscv_assembly_PushLocalValue, getFrameOffset(*symbol_entry));
             }
         }
     }
 }
 
-void CodeGenerator::visit(ConstantValueNode &p_constant_value)
+void CodeGenerator::visit(ConstantValueNode &p_constant_value)
+{
+    constexpr const char *const riscv_assembly_push = "    addi sp, sp, -4\n"
+                                                      "    sw t0, 0(sp)\n";
+    if (const auto *immediate = asImmediateOperand(p_constant_value))
+    {
+        emitLoadImmediate("t0", immediateValueOf(*immediate));
+        dumpInstructions(m_output_file.get(), riscv_assembly_push);
+    }
+    else if (p_constant_value.getTypePtr()->isReal())
+    {
+        // Floats have no immediate form; they are loaded from the pool.
+        dumpInstructions(m_output_file.get(), "    la t0, %s\n"
+                                              "    flw ft0, 0(t0)\n"
+                                              "    addi sp, sp, -4\n"
+                                              "    fsw ft0, 0(sp)\n",
+                         getRealConstantLabel(p_constant_value.getConstantPtr()->real()).c_str());
+    }
+    else
+    {
+        // A string is the address of its literal in the pool.
+        dumpInstructions(m_output_file.get(), "    la t0, %s\n",
+                         getStringConstantLabel(p_constant_value.getConstantValueCString()).c_str());
+        dumpInstructions(m_output_file.get(), riscv_assembly_push);
+    }
+}
+
+void CodeGenerator::visitCoerced(ExpressionNode &p_expr, const PType *p_type)
+{
+    const PType *type = p_expr.getInferredType();
+    if (!p_type || !p_type->isReal() || !type || !type->isInteger())
+    {
+        p_expr.accept(*this);
+        return;
+    }
+
+    // An integer constant is converted at compile time.
+    if (const auto *immediate = asImmediateOperand(p_expr))
+    {
+        dumpInstructions(m_output_file.get(), "    la t0, %s\n"
+                                              "    flw ft0, 0(t0)\n"
+                                              "    addi sp, sp, -4\n"
+                                              "    fsw ft0, 0(sp)\n",
+                         getRealConstantLabel(double(immediateValueOf(*immediate))).c_str());
+        return;
+    }
+    p_expr.accept(*this);
+    dumpInstructions(m_output_file.get(), "    lw t0, 0(sp)\n"
+                                          "    fcvt.s.w ft0, t0\n"
+                                          "    fsw ft0, 0(sp)\n");
+}
+
+static std::string realConstantLabelOf(const uint32_t p_bits)
+{
+    char label[16];
+    snprintf(label, sizeof(label), ".LR%08" PRIx32, p_bits);
+    return label;
+}
+
+static std::string stringConstantLabelOf(const std::string &p_string)
+{
+    char label[24];
+    snprintf(label, sizeof(label), ".LS%016" PRIx64, FunctionHasher::hashString(p_string));
+    return label;
+}
+
+std::string CodeGenerator::getRealConstantLabel(double p_value)
+{
+    const uint32_t bits = floatBitsOf(p_value);
+    poolRealConstant(bits);
+    return realConstantLabelOf(bits);
+}
+
+std::string CodeGenerator::getStringConstantLabel(const std::string &p_string)
+{
+    poolStringConstant(p_string);
+    return stringConstantLabelOf(p_string);
+}
+
+void CodeGenerator::poolRealConstant(uint32_t p_bits)
+{
+    if (m_pooled_reals.insert(p_bits).second)
+        m_real_constants.push_back(p_bits);
+    if (m_cached_function)
+    {
+        auto &reals = m_cached_function->m_real_constants;
+        if (std::find(reals.begin(), reals.end(), p_bits) == reals.end())
+            reals.push_back(p_bits);
+    }
+}
+
+void CodeGenerator::poolStringConstant(const std::string &p_string)
+{
+    if (m_pooled_strings.insert(p_string).second)
+        m_string_constants.push_back(p_string);
+    if (m_cached_function)
+    {
+        auto &strings = m_cached_function->m_string_constants;
+        if (std::find(strings.begin(), strings.end(), p_string) == strings.end())
+            strings.push_back(p_string);
+    }
+}
+
+void CodeGenerator::emitConstantPool()
+{
+    if (m_real_constants.empty() && m_string_constants.empty())
+        return;
+    dumpInstructions(m_output_file.get(), "\n.section    .rodata\n"
+                                          "    .align 2\n");
+    for (const auto bits : m_real_constants)
+        dumpInstructions(m_output_file.get(), "%s:\n"
+                                              "    .word %u\n",
+                         realConstantLabelOf(bits).c_str(), bits);
+    for (const auto &string : m_string_constants)
+        dumpInstructions(m_output_file.get(), "%s:\n"
+                                              "    .string %s\n",
+                         stringConstantLabelOf(string).c_str(),
+                         quoteAssemblyString(string).c_str());
+}
+
+void CodeGenerator::setFunctionCacheDirectory(const std::string &p_directory)
+{
+    m_function_cache.reset(new FunctionCache(p_directory));
+}
+
+void CodeGenerator::computeFunctionCacheKeys(ProgramNode &p_program)
+{
+    // The key also changes with the code generator itself.
+    std::string globals = CODEGEN_BUILD_ID;
+    FunctionHasher hasher;
+    if (m_prelude)
+        for (const auto &decl_node : m_prelude->getDeclNodes())
+            globals += " " + std::to_string(hasher.hash(*decl_node));
+    for (const auto &decl_node : p_program.getDeclNodes())
+        globals += " " + std::to_string(hasher.hash(*decl_node));
+    // The globals imported from interfaces have no declaration in the program.
+    for (const auto &entry : m_symbol_table_of_scoping_nodes.at(&p_program)->getEntries())
+    {
+        if (entry.getKind() != SymbolEntry::KindEnum::kVariableKind &&
+            entry.getKind() != SymbolEntry::KindEnum::kConstantKind)
+            continue;
+        globals += " " + entry.getName() + ":" + entry.getTypePtr()->getPTypeCString();
+        if (entry.getAttribute().constant())
+            globals += "=" + FunctionHasher::keyOf(*entry.getAttribute().constant());
+    }
+
+    std::unordered_map<std::string, std::pair<uint64_t, std::set<std::string>>> functions;
+    for (const auto &func_node : p_program.getFuncNodes())
+    {
+        const uint64_t hash = hasher.hash(*func_node);
+        functions.emplace(func_node->getName(), std::make_pair(hash, hasher.getCallees()));
+    }
+
+    // Only leaves are inlined, and the code of a call out of line depends only
+    // on the signature of the callee, so the direct callees suffice.
+    m_function_cache_keys.clear();
+    for (const auto &function : functions)
+    {
+        std::string key = globals + " " + function.first + ":" +
+                          std::to_string(function.second.first);
+        for (const auto &callee : function.second.second)
+        {
+            key += " " + callee + ":";
+            auto it = functions.find(callee);
+            const SymbolEntry *entry = m_symbol_manager.lookup(callee);
+            if (it != functions.end())
+                key += std::to_string(it->second.first);
+            else if (entry) // A function of another unit is only known by its signature.
+                key += std::string{entry->getTypePtr()->getPTypeCString()} + "(" +
+                       FunctionNode::getParametersTypeString(*entry->getAttribute().parameters()) + ")";
+            key += m_inline_analyzer.getInlineTarget(callee) ? ":inline" : ":call";
+        }
+        m_function_cache_keys.emplace(function.first, FunctionHasher::hashString(key));
+    }
+}
+
+bool CodeGenerator::emitCachedFunction(const FunctionNode &p_function)
 {
-    constexpr const char *const riscv_assembly_constant = "    li t0, %s\n"
-                                                          "    addi sp, sp, -4\n"
-                                                          "    sw t0, 0(sp)\n";
-    const char *value = p_constant_value.getConstantValueCString();
-    const char *output_value = value;
-    if (p_constant_value.getTypePtr()->isBool())
-        output_value = p_constant_value.getConstantPtr()->boolean() ? "1" : "0";
-    dumpInstructions(m_output_file.get(), riscv_assembly_constant, output_value);
+    CachedFunction cached;
+    if (!m_function_cache->load(m_function_cache_keys.at(p_function.getName()), cached))
+        return false;
+    for (const auto bits : cached.m_real_constants)
+        poolRealConstant(bits);
+    for (const auto &string : cached.m_string_constants)
+        poolStringConstant(string);
+    fwrite(cached.m_assembly.data(), 1, cached.m_assembly.size(), m_output_file.get());
+    return true;
 }
 
 void CodeGenerator::visit(FunctionNode &p_function)
+{
+    // A declaration without a body refers to a function of another unit; the
+    // assembler leaves the undefined symbol to the linker.
+    if (!p_function.getBody())
+        return;
+    if (!m_function_cache)
+    {
+        emitFunction(p_function);
+        return;
+    }
+    if (emitCachedFunction(p_function))
+        return;
+
+    // The whole function, from its section directive to its size, is
+    // captured for the cache.
+    CachedFunction cached;
+    char *text = nullptr;
+    size_t text_size = 0;
+    auto output_file = std::move(m_output_file);
+    m_output_file.reset(open_memstream(&text, &text_size));
+    assert(m_output_file.get() && "Failed to open the function buffer");
+    m_cached_function = &cached;
+    emitFunction(p_function);
+    m_cached_function = nullptr;
+    // Flushes the buffer and updates `text_size`.
+    m_output_file = std::move(output_file);
+    cached.m_assembly.assign(text, text_size);
+    free(text);
+
+    fwrite(cached.m_assembly.data(), 1, cached.m_assembly.size(), m_output_file.get());
+    m_function_cache->store(m_function_cache_keys.at(p_function.getName()), cached);
+}
+
+void CodeGenerator::emitFunction(FunctionNode &p_function)
 {
     // Reconstruct the scope for looking up the symbol entry.
-    m_symbol_manager.pushScope(
-        std::move(m_symbol_table_of_scoping_nodes.at(&p_function)));
+    enterScope(p_function);
     m_parameter_count = 0;
+    m_parameter_registers = argumentRegistersOf(parameterTypesOf(p_function.getParameters()));
+    m_return_type = p_function.getTypePtr();
+    m_current_function_name = p_function.getName();
     const char *function_name = p_function.getNameCString();
     constexpr const char *const riscv_assembly_function_start = "\n.section    .text\n"
                                                                 "   .align 2\n"
@@ -242,60 +1289,255 @@ void CodeGenerator::visit(FunctionNode &p_function)
                                                                 "   .type %s, @function\n\n%s:\n";
     constexpr const char *const riscv_assembly_function_end = "    .size %s, .-%s\n";
 
-    constexpr const char *const riscv_assembly_prologue = "    addi sp, sp, -128\n"
-                                                          "    sw ra, 124(sp)\n"
-                                                          "    sw s0, 120(sp)\n"
-                                                          "    addi s0, sp, 128\n\n";
-    constexpr const char *const riscv_assembly_epilogue = "    lw ra, 124(sp)\n"
-                                                          "    lw s0, 120(sp)\n"
-                                                          "    addi sp, sp, 128\n"
-                                                          "    jr ra\n";
     dumpInstructions(m_output_file.get(), riscv_assembly_function_start, function_name, function_name, function_name);
-    m_current_offset = -8;
-    dumpInstructions(m_output_file.get(), riscv_assembly_prologue);
+    beginFunctionBody(m_inline_analyzer.hasOutOfLineCall(p_function.getName()));
+    if (p_function.getBody())
+        m_dead_stores.analyze(const_cast<CompoundStatementNode &>(*p_function.getBody()));
     p_function.visitParamChildNodes(*this);
-    p_function.visitBodyChildNodes(*this);
-    dumpInstructions(m_output_file.get(), riscv_assembly_epilogue);
+
+    m_current_function = &p_function;
+    m_parameter_offsets.clear();
+    for (const auto &decl_node : p_function.getParameters())
+        for (const auto &variable : decl_node->getVariables())
+            m_parameter_offsets.push_back(getFrameOffset(*m_symbol_manager.lookup(variable->getName())));
+    m_tail_call_label = m_label_count++;
+    dumpInstructions(m_output_file.get(), "%s%d:\n", m_label_prefix.c_str(), m_tail_call_label);
+
+    if (p_function.getBody())
+        visitStatements(*p_function.getBody());
+    m_current_function = nullptr;
+    m_return_type = nullptr;
+    // A body that returns on every path has emitted the epilogue already.
+    if (!p_function.getBody() || !alwaysReturns(*p_function.getBody()))
+    {
+        emitFrameTeardown();
+        dumpInstructions(m_output_file.get(), "    jr ra\n");
+    }
+    endFunctionBody();
     dumpInstructions(m_output_file.get(), riscv_assembly_function_end, function_name, function_name);
 
     // Remove the entries in the hash table
-    m_symbol_manager.popScope();
+    leaveScope(p_function);
 }
 
 void CodeGenerator::visit(CompoundStatementNode &p_compound_statement)
 {
 
     // Reconstruct the scope for looking up the symbol entry.
-    m_symbol_manager.pushScope(
-        std::move(m_symbol_table_of_scoping_nodes.at(&p_compound_statement)));
-    p_compound_statement.visitChildNodes(*this);
-    m_symbol_manager.popScope();
+    enterScope(p_compound_statement);
+    visitStatements(p_compound_statement);
+    leaveScope(p_compound_statement);
+}
+
+/// @return Whether the statement has no control flow of its own and can be
+/// part of a basic block.
+static bool isStraightLine(const AstNode &p_statement)
+{
+    return dynamic_cast<const AssignmentNode *>(&p_statement) ||
+           dynamic_cast<const PrintNode *>(&p_statement) ||
+           dynamic_cast<const ReadNode *>(&p_statement) ||
+           dynamic_cast<const ReturnNode *>(&p_statement) ||
+           dynamic_cast<const FunctionInvocationNode *>(&p_statement);
+}
+
+void CodeGenerator::visitStatements(const CompoundStatementNode &p_block)
+{
+    for (const auto &decl_node : p_block.getDeclarations())
+        decl_node->accept(*this);
+
+    const auto &statements = p_block.getStatements();
+    size_t block_end = 0;
+    std::vector<const ExpressionNode *> block_exprs;
+    for (size_t i = 0; i < statements.size(); ++i)
+    {
+        if (i >= block_end && isStraightLine(*statements[i]))
+        {
+            // A basic block ends before the next control-flow statement or
+            // right after a `return`.
+            std::vector<const AstNode *> block;
+            for (block_end = i; block_end < statements.size() && isStraightLine(*statements[block_end]);)
+            {
+                const auto *statement = statements[block_end++].get();
+                // Dead stores are not emitted, so they compute nothing.
+                const auto *assignment = dynamic_cast<const AssignmentNode *>(statement);
+                if (!assignment || !isDeadStore(assignment->getLvalue()) ||
+                    DeadStoreAnalyzer::hasSideEffects(assignment->getExpr()))
+                    block.push_back(statement);
+                if (dynamic_cast<const ReturnNode *>(statement))
+                    break;
+            }
+            beginBasicBlock(block, block_exprs);
+        }
+
+        statements[i]->accept(*this);
+
+        const auto *invocation = dynamic_cast<const FunctionInvocationNode *>(statements[i].get());
+        if (invocation)
+        {
+            const SymbolEntry *callee = invocation->getSymbolEntry();
+            if (callee && !callee->getTypePtr()->isVoid())
+                dumpInstructions(m_output_file.get(), "    addi sp, sp, 4\n");
+        }
+
+        if (i + 1 == block_end)
+            endBasicBlock(block_exprs);
+        // The rest of the block is unreachable.
+        if (alwaysReturns(*statements[i]))
+            break;
+    }
+}
+
+void CodeGenerator::beginBasicBlock(const std::vector<const AstNode *> &p_block,
+                                    std::vector<const ExpressionNode *> &p_exprs)
+{
+    LocalValueNumbering value_numbering(m_hoisted_expr_offsets);
+    value_numbering.analyze(p_block);
+
+    for (const auto *expr : value_numbering.getSavedExpressions())
+    {
+        if (m_cse_slots_in_use == m_cse_slots.size())
+            m_cse_slots.push_back(allocateFrameSlot());
+        m_cse_save_offsets[expr] = m_cse_slots[m_cse_slots_in_use++];
+        p_exprs.push_back(expr);
+    }
+    for (const auto &reuse : value_numbering.getReusedExpressions())
+    {
+        m_hoisted_expr_offsets[reuse.first] = m_cse_save_offsets.at(reuse.second);
+        p_exprs.push_back(reuse.first);
+    }
+}
+
+void CodeGenerator::endBasicBlock(std::vector<const ExpressionNode *> &p_exprs)
+{
+    for (const auto *expr : p_exprs)
+    {
+        if (m_cse_save_offsets.erase(expr))
+            --m_cse_slots_in_use;
+        else
+            m_hoisted_expr_offsets.erase(expr);
+    }
+    p_exprs.clear();
+}
+
+void CodeGenerator::saveCommonValue(const ExpressionNode &p_expr)
+{
+    auto saved = m_cse_save_offsets.find(&p_expr);
+    if (saved == m_cse_save_offsets.end())
+        return;
+    // Operators on reals leave their result in ft0 instead.
+    if (isRealExpression(p_expr) && !dynamic_cast<const VariableReferenceNode *>(&p_expr))
+        dumpInstructions(m_output_file.get(), "    fsw ft0, %d(s0)\n", saved->second);
+    else
+        dumpInstructions(m_output_file.get(), "    sw t0, %d(s0)\n", saved->second);
 }
 
 void CodeGenerator::visit(PrintNode &p_print)
 {
     constexpr const char *const riscv_assembly_print = "    lw a0, 0(sp)\n"
-                                                       "    addi sp, sp, 4\n"
-                                                       "    jal ra, printInt\n";
+                                                       "    addi sp, sp, 4\n";
 
     p_print.visitChildNodes(*this);
 
-    dumpInstructions(m_output_file.get(), riscv_assembly_print);
+    if (isStringExpression(p_print.getTarget()))
+    {
+        dumpInstructions(m_output_file.get(), riscv_assembly_print);
+        emitRuntimeCall("printString");
+    }
+    else if (isRealExpression(p_print.getTarget()))
+    {
+        dumpInstructions(m_output_file.get(), "    flw fa0, 0(sp)\n"
+                                              "    addi sp, sp, 4\n");
+        emitRuntimeCall("printReal");
+    }
+    else
+    {
+        dumpInstructions(m_output_file.get(), riscv_assembly_print);
+        emitRuntimeCall("printInt");
+    }
 }
 
 void CodeGenerator::visit(BinaryOperatorNode &p_bin_op)
 {
+    if (pushHoistedValue(p_bin_op))
+        return;
+    emitBinaryOperator(p_bin_op);
+    saveCommonValue(p_bin_op);
+}
 
-    p_bin_op.visitChildNodes(*this);
-    m_is_binary_condition = true;
+void CodeGenerator::emitBinaryOperator(BinaryOperatorNode &p_bin_op)
+{
     constexpr const char *const riscv_assembly_pop_operands = "    lw t0, 0(sp)\n"
                                                               "    addi sp, sp, 4\n"
                                                               "    lw t1, 0(sp)\n"
                                                               "    addi sp, sp, 4\n";
+    constexpr const char *const riscv_assembly_pop_left = "    lw t1, 0(sp)\n"
+                                                          "    addi sp, sp, 4\n";
     constexpr const char *const kPushResult = "    addi sp, sp, -4\n"
                                               "    sw t0, 0(sp)\n";
-    dumpInstructions(m_output_file.get(), riscv_assembly_pop_operands);
     Operator op = p_bin_op.getOp();
+    if (isRealOperation(p_bin_op))
+    {
+        emitRealBinaryOperator(p_bin_op);
+        return;
+    }
+    if ((op == Operator::kAndOp || op == Operator::kOrOp) &&
+        DeadStoreAnalyzer::hasSideEffects(p_bin_op.getRightOperand()))
+    {
+        // The right operand must not be evaluated if the left one decides the
+        // result, so branch on the condition and materialize the outcome.
+        const int false_label = m_label_count++;
+        const int end_label = m_label_count++;
+        genCondBranch(p_bin_op, 0, false_label);
+        dumpInstructions(m_output_file.get(), "    li t0, 1\n"
+                                              "    j %s%d\n"
+                                              "%s%d:\n"
+                                              "    li t0, 0\n"
+                                              "%s%d:\n",
+                         m_label_prefix.c_str(), end_label, m_label_prefix.c_str(), false_label,
+                         m_label_prefix.c_str(), end_label);
+        dumpInstructions(m_output_file.get(), kPushResult);
+        return;
+    }
+    if (isStringExpression(p_bin_op))
+    {
+        // Concatenation allocates the result in the runtime.
+        p_bin_op.visitChildNodes(*this);
+        dumpInstructions(m_output_file.get(), "    lw a1, 0(sp)\n"
+                                              "    addi sp, sp, 4\n"
+                                              "    lw a0, 0(sp)\n"
+                                              "    addi sp, sp, 4\n");
+        emitRuntimeCall("concatString");
+        dumpInstructions(m_output_file.get(), "    mv t0, a0\n");
+        dumpInstructions(m_output_file.get(), kPushResult);
+        return;
+    }
+
+    // A constant operand never goes through the stack: it is either folded
+    // into an I-type instruction or materialized directly in t0.
+    const ExpressionNode *variable_operand = &p_bin_op.getLeftOperand();
+    const ConstantValueNode *immediate = asImmediateOperand(p_bin_op.getRightOperand());
+    if (!immediate && isCommutative(op))
+    {
+        immediate = asImmediateOperand(p_bin_op.getLeftOperand());
+        variable_operand = &p_bin_op.getRightOperand();
+    }
+
+    if (immediate)
+    {
+        const_cast<ExpressionNode *>(variable_operand)->accept(*this);
+        dumpInstructions(m_output_file.get(), riscv_assembly_pop_left);
+        if (emitImmediateBinaryOp(op, immediateValueOf(*immediate)))
+        {
+            dumpInstructions(m_output_file.get(), kPushResult);
+            return;
+        }
+        emitLoadImmediate("t0", immediateValueOf(*immediate));
+    }
+    else
+    {
+        p_bin_op.visitChildNodes(*this);
+        dumpInstructions(m_output_file.get(), riscv_assembly_pop_operands);
+    }
     switch (op)
     {
     case Operator::kPlusOp:
@@ -320,124 +1562,112 @@ void CodeGenerator::visit(BinaryOperatorNode &p_bin_op)
         dumpInstructions(m_output_file.get(), "    or t0, t1, t0\n");
         break;
 
+    // Comparisons reaching here are used as values; conditions are lowered
+    // to branches by `genCondBranch` instead.
     case Operator::kEqualOp:
-        if (!m_assign_bool)
-        {
-            // if (a == b) false 時跳過 then
-            dumpInstructions(m_output_file.get(),
-                             "    bne t1, t0, L%d\n",
-                             jump_label);
-        }
-        else
-        {
-            // result := (a == b) ? 1 : 0
-            dumpInstructions(m_output_file.get(),
-                             "    sub  t0, t1, t0\n"); // t0 = t1 - t0
-            dumpInstructions(m_output_file.get(),
-                             "    seqz t0, t0\n"); // t0 = (t0==0)?1:0
-        }
+        dumpInstructions(m_output_file.get(), "    sub t0, t1, t0\n"
+                                              "    seqz t0, t0\n");
         break;
-
     case Operator::kNotEqualOp:
-        if (!m_assign_bool)
-        {
-            // if (a != b) false 時跳過 then
-            dumpInstructions(m_output_file.get(),
-                             "    beq  t1, t0, L%d\n",
-                             jump_label);
-        }
-        else
-        {
-            // result := (a != b) ? 1 : 0
-            dumpInstructions(m_output_file.get(),
-                             "    sub  t0, t1, t0\n"); // t0 = t1 - t0
-            dumpInstructions(m_output_file.get(),
-                             "    snez t0, t0\n"); // t0 = (t0!=0)?1:0
-        }
+        dumpInstructions(m_output_file.get(), "    sub t0, t1, t0\n"
+                                              "    snez t0, t0\n");
         break;
-
     case Operator::kLessOp:
-        if (!m_assign_bool)
-        {
-            // if (a < b) false 時跳過 then
-            dumpInstructions(m_output_file.get(),
-                             "    bge  t1, t0, L%d\n",
-                             jump_label);
-        }
-        else
-        {
-            // result := (a < b) ? 1 : 0
-            dumpInstructions(m_output_file.get(),
-                             "    slt  t0, t1, t0\n"); // t0 = (t1<t0)?1:0
-        }
+        dumpInstructions(m_output_file.get(), "    slt t0, t1, t0\n");
         break;
-
     case Operator::kGreaterOp:
-        if (!m_assign_bool)
-        {
-            // if (a > b) false 時跳過 then
-            dumpInstructions(m_output_file.get(),
-                             "    ble  t1, t0, L%d\n",
-                             jump_label);
-        }
-        else
-        {
-            // result := (a > b) ? 1 : 0
-            dumpInstructions(m_output_file.get(),
-                             "    slt  t0, t0, t1\n"); // t0 = (t0<t1)?1:0
-        }
+        dumpInstructions(m_output_file.get(), "    slt t0, t0, t1\n");
         break;
-
     case Operator::kLessOrEqualOp:
-        if (!m_assign_bool)
-        {
-            // if (a <= b) false 時跳過 then
-            dumpInstructions(m_output_file.get(),
-                             "    bgt  t1, t0, L%d\n",
-                             jump_label);
-        }
-        else
-        {
-            // result := (a <= b) ? 1 : 0
-            dumpInstructions(m_output_file.get(),
-                             "    slt  t0, t0, t1\n"); // t0 = (b<a)?1:0
-            dumpInstructions(m_output_file.get(),
-                             "    xori t0, t0, 1\n"); // t0 = !t0
-        }
+        dumpInstructions(m_output_file.get(), "    slt t0, t0, t1\n"
+                                              "    xori t0, t0, 1\n");
         break;
-
     case Operator::kGreaterOrEqualOp:
-        if (!m_assign_bool)
-        {
-            // if (a >= b) false 時跳過 then
-            dumpInstructions(m_output_file.get(),
-                             "    blt  t1, t0, L%d\n",
-                             jump_label);
-        }
-        else
-        {
-            // result := (a >= b) ? 1 : 0
-            dumpInstructions(m_output_file.get(),
-                             "    slt  t0, t1, t0\n"); // t0 = (a<b)?1:0
-            dumpInstructions(m_output_file.get(),
-                             "    xori t0, t0, 1\n"); // t0 = !t0
-        }
+        dumpInstructions(m_output_file.get(), "    slt t0, t1, t0\n"
+                                              "    xori t0, t0, 1\n");
         break;
-
     default:
         break;
     }
-    if (op == Operator::kPlusOp || op == Operator::kMinusOp ||
-        op == Operator::kMultiplyOp || op == Operator::kDivideOp ||
-        op == Operator::kModOp || op == Operator::kAndOp ||
-        op == Operator::kOrOp || m_assign_bool)
+    dumpInstructions(m_output_file.get(), kPushResult);
+}
+
+void CodeGenerator::emitRealBinaryOperator(BinaryOperatorNode &p_bin_op)
+{
+    const PType real_type(PType::PrimitiveTypeEnum::kRealType);
+    visitCoerced(const_cast<ExpressionNode &>(p_bin_op.getLeftOperand()), &real_type);
+    visitCoerced(const_cast<ExpressionNode &>(p_bin_op.getRightOperand()), &real_type);
+    dumpInstructions(m_output_file.get(), "    flw ft0, 0(sp)\n"
+                                          "    addi sp, sp, 4\n"
+                                          "    flw ft1, 0(sp)\n"
+                                          "    addi sp, sp, 4\n");
+
+    const char *real_result = nullptr;
+    const char *bool_result = nullptr;
+    switch (p_bin_op.getOp())
     {
-        dumpInstructions(m_output_file.get(), kPushResult);
+    case Operator::kPlusOp:
+        real_result = "    fadd.s ft0, ft1, ft0\n";
+        break;
+    case Operator::kMinusOp:
+        real_result = "    fsub.s ft0, ft1, ft0\n";
+        break;
+    case Operator::kMultiplyOp:
+        real_result = "    fmul.s ft0, ft1, ft0\n";
+        break;
+    case Operator::kDivideOp:
+        real_result = "    fdiv.s ft0, ft1, ft0\n";
+        break;
+    case Operator::kEqualOp:
+        bool_result = "    feq.s t0, ft1, ft0\n";
+        break;
+    case Operator::kNotEqualOp:
+        bool_result = "    feq.s t0, ft1, ft0\n"
+                      "    xori t0, t0, 1\n";
+        break;
+    case Operator::kLessOp:
+        bool_result = "    flt.s t0, ft1, ft0\n";
+        break;
+    case Operator::kLessOrEqualOp:
+        bool_result = "    fle.s t0, ft1, ft0\n";
+        break;
+    case Operator::kGreaterOp:
+        bool_result = "    flt.s t0, ft0, ft1\n";
+        break;
+    case Operator::kGreaterOrEqualOp:
+        bool_result = "    fle.s t0, ft0, ft1\n";
+        break;
+    default:
+        assert(false && "Not an operator on reals");
+        return;
     }
+
+    if (real_result)
+        dumpInstructions(m_output_file.get(), "%s"
+                                              "    addi sp, sp, -4\n"
+                                              "    fsw ft0, 0(sp)\n",
+                         real_result);
+    else
+        dumpInstructions(m_output_file.get(), "%s"
+                                              "    addi sp, sp, -4\n"
+                                              "    sw t0, 0(sp)\n",
+                         bool_result);
 }
+
 void CodeGenerator::visit(UnaryOperatorNode &p_un_op)
 {
+    if (pushHoistedValue(p_un_op))
+        return;
+
     p_un_op.visitChildNodes(*this);
+    if (p_un_op.getOp() == Operator::kNegOp && isRealExpression(p_un_op))
+    {
+        dumpInstructions(m_output_file.get(), "    flw ft0, 0(sp)\n"
+                                              "    fneg.s ft0, ft0\n"
+                                              "    fsw ft0, 0(sp)\n");
+        saveCommonValue(p_un_op);
+        return;
+    }
     constexpr const char *const riscv_assembly_unop_s = "    lw t0, 0(sp)\n"
                                                         "    addi sp, sp, 4\n";
     constexpr const char *const riscv_assembly_unop_e = "    addi sp, sp, -4\n"
@@ -455,8 +1685,8 @@ void CodeGenerator::visit(UnaryOperatorNode &p_un_op)
     }
     case Operator::kNotOp:
     {
-        constexpr const char *const riscv_assembly_unop = "    li t1, -1\n"
-                                                          "    add t0, t0, t1\n";
+        // Booleans are always 0 or 1.
+        constexpr const char *const riscv_assembly_unop = "    xori t0, t0, 1\n";
         dumpInstructions(m_output_file.get(), riscv_assembly_unop);
         dumpInstructions(m_output_file.get(), riscv_assembly_unop_e);
         break;
@@ -464,37 +1694,71 @@ void CodeGenerator::visit(UnaryOperatorNode &p_un_op)
     default:
         break;
     }
+    saveCommonValue(p_un_op);
 }
 
 void CodeGenerator::visit(FunctionInvocationNode &p_func_invocation)
 {
-    constexpr const char *const riscv_assembly_invocation_a = "    lw a%d, 0(sp)\n"
-                                                              "    addi sp, sp, 4\n";
-    constexpr const char *const riscv_assembly_invocation_t = "    lw t%d, 0(sp)\n"
-                                                              "    addi sp, sp, 4\n";
-    constexpr const char *const riscv_assembly_invocation_epilogue = "    jal ra, %s\n"
-                                                                     "    mv t0, a0\n"
-                                                                     "    addi sp, sp, -4\n"
-                                                                     "    sw t0, 0(sp)\n";
+    constexpr const char *const riscv_assembly_invocation = "    jal ra, %s\n";
+    constexpr const char *const riscv_assembly_push_result = "    mv t0, a0\n"
+                                                             "    addi sp, sp, -4\n"
+                                                             "    sw t0, 0(sp)\n";
+
+    if (emitInlinedCall(p_func_invocation))
+        return;
 
+    const SymbolEntry *callee = p_func_invocation.getSymbolEntry();
+    const auto parameter_types = parameterTypesOf(*callee->getAttribute().parameters());
+    const auto &arguments = p_func_invocation.getArguments();
     m_is_in_function_invocation = true;
-    p_func_invocation.visitChildNodes(*this);
+    for (size_t i = 0; i < arguments.size(); ++i)
+        visitCoerced(*arguments[i], parameter_types[i]);
     m_is_in_function_invocation = false;
-    for (int i = int(p_func_invocation.getArguments().size()) - 1; i >= 0; i--)
+
+    // The arguments are on the stack with the last one on top. s1 keeps their
+    // base across the call, so that sp can be aligned to 16 bytes no matter how
+    // many temporaries are pushed, and the outgoing area for the arguments
+    // beyond the 8th can be laid out in order at 0(sp), 4(sp), ...
+    const int num_args = int(arguments.size());
+    const auto registers = argumentRegistersOf(parameter_types);
+    const int num_stack_args = int(std::count(registers.begin(), registers.end(), ""));
+    dumpInstructions(m_output_file.get(), "    mv s1, sp\n");
+    if (num_stack_args > 0)
+        dumpInstructions(m_output_file.get(), "    addi sp, sp, -%d\n", num_stack_args * 4);
+    dumpInstructions(m_output_file.get(), "    andi sp, sp, -16\n");
+    int stack_arg_offset = 0;
+    for (int i = 0; i < num_args; i++)
     {
-        if (i < 8)
+        const int arg_offset = (num_args - 1 - i) * 4;
+        if (!registers[i].empty())
+            dumpInstructions(m_output_file.get(), "    %s %s, %d(s1)\n",
+                             isFloatRegister(registers[i]) ? "flw" : "lw",
+                             registers[i].c_str(), arg_offset);
+        else
         {
-            dumpInstructions(m_output_file.get(), riscv_assembly_invocation_a, i);
+            dumpInstructions(m_output_file.get(), "    lw t0, %d(s1)\n"
+                                                  "    sw t0, %d(sp)\n",
+                             arg_offset, stack_arg_offset);
+            stack_arg_offset += 4;
         }
-        else
-            dumpInstructions(m_output_file.get(), riscv_assembly_invocation_t, i % 8 + 2);
     }
-    dumpInstructions(m_output_file.get(), riscv_assembly_invocation_epilogue, p_func_invocation.getNameCString());
+    dumpInstructions(m_output_file.get(), riscv_assembly_invocation, p_func_invocation.getNameCString());
+    dumpInstructions(m_output_file.get(), "    addi sp, s1, %d\n", num_args * 4);
+
+    // Procedures have no result to push.
+    if (callee->getTypePtr()->isReal())
+        dumpInstructions(m_output_file.get(), "    addi sp, sp, -4\n"
+                                              "    fsw fa0, 0(sp)\n");
+    else if (!callee->getTypePtr()->isVoid())
+        dumpInstructions(m_output_file.get(), riscv_assembly_push_result);
 }
 
 void CodeGenerator::visit(VariableReferenceNode &p_variable_ref)
 {
-    SymbolEntry *symbol_entry = const_cast<SymbolEntry *>(m_symbol_manager.lookup(p_variable_ref.getName()));
+    if (!p_variable_ref.getIndices().empty() && pushHoistedValue(p_variable_ref))
+        return;
+
+    const SymbolEntry *symbol_entry = p_variable_ref.getSymbolEntry();
     if (!symbol_entry)
         return;
     const char *variable_name = symbol_entry->getNameCString();
@@ -507,7 +1771,34 @@ void CodeGenerator::visit(VariableReferenceNode &p_variable_ref)
                                                                  "    addi sp, sp, -4\n"
                                                                  "    sw t0, 0(sp)\n";
     bool is_get_address = (m_assign_left || m_is_in_read) && !m_is_in_function_invocation;
-    if (symbol_entry->getLevel() == 0) // global
+    const auto &dimensions = symbol_entry->getTypePtr()->getDimensions();
+    if (!dimensions.empty())
+    {
+        // An array without all of its indices stands for its address.
+        const bool is_element = p_variable_ref.getIndices().size() == dimensions.size();
+        auto induction = m_induction_ref_offsets.find(&p_variable_ref);
+        if (induction != m_induction_ref_offsets.end())
+            dumpInstructions(m_output_file.get(), "    lw t0, %d(s0)\n"
+                                                  "    addi sp, sp, -4\n"
+                                                  "    sw t0, 0(sp)\n",
+                             induction->second);
+        else
+            emitElementAddress(p_variable_ref, *symbol_entry);
+        if (is_element && !is_get_address)
+            dumpInstructions(m_output_file.get(), "    lw t0, 0(sp)\n"
+                                                  "    lw t0, 0(t0)\n"
+                                                  "    sw t0, 0(sp)\n");
+    }
+    else if (symbol_entry->getLevel() == 0 && m_hoisted_address_offsets.count(variable_name))
+    {
+        // The address was computed in the preheader of an enclosing loop.
+        emitGlobalAddress("t0", variable_name);
+        if (!is_get_address)
+            dumpInstructions(m_output_file.get(), "    lw t0, 0(t0)\n");
+        dumpInstructions(m_output_file.get(), "    addi sp, sp, -4\n"
+                                              "    sw t0, 0(sp)\n");
+    }
+    else if (symbol_entry->getLevel() == 0) // global
     {
         if (is_get_address)
             dumpInstructions(m_output_file.get(), riscv_assembly_PushGlobalAddress, variable_name);
@@ -523,10 +1814,11 @@ void CodeGenerator::visit(VariableReferenceNode &p_variable_ref)
                                                                     "    addi sp, sp, -4\n"
                                                                     "    sw t0, 0(sp)\n";
         if (is_get_address)
-            dumpInstructions(m_output_file.get(), riscv_assembly_PushLocalAddress, symbol_entry->getOffset());
+            dumpInstructions(m_output_file.get(), riscv_assembly_PushLocalAddress, getFrameOffset(*symbol_entry));
         else
-            dumpInstructions(m_output_file.get(), riscv_assembly_PushLocalValue, symbol_entry->getOffset());
+            dumpInstructions(m_output_file.get(), riscv_assembly_PushLocalValue, getFrameOffset(*symbol_entry));
     }
+    saveCommonValue(p_variable_ref);
 }
 
 void CodeGenerator::visit(AssignmentNode &p_assignment)
@@ -538,169 +1830,219 @@ void CodeGenerator::visit(AssignmentNode &p_assignment)
                                                             "    addi sp, sp, 4\n"
                                                             "    sw t0, 0(t1)\n";
 
+    const auto &lvalue = p_assignment.getLvalue();
+    const auto *immediate = asImmediateOperand(p_assignment.getExpr());
+    const SymbolEntry *lvalue_entry = lvalue.getSymbolEntry();
+    if (isDeadStore(lvalue) && !DeadStoreAnalyzer::hasSideEffects(p_assignment.getExpr()))
+        return;
+    if (immediate && lvalue_entry && lvalue.getIndices().empty() &&
+        !lvalue_entry->getTypePtr()->isReal())
+    {
+        // Store a constant straight to its destination.
+        emitLoadImmediate("t0", immediateValueOf(*immediate));
+        if (lvalue_entry->getLevel() == 0)
+        {
+            emitGlobalAddress("t1", lvalue_entry->getNameCString());
+            dumpInstructions(m_output_file.get(), "    sw t0, 0(t1)\n");
+        }
+        else
+            dumpInstructions(m_output_file.get(), "    sw t0, %d(s0)\n",
+                             getFrameOffset(*lvalue_entry));
+        return;
+    }
+
     m_assign_left = true;
-    const_cast<VariableReferenceNode &>(p_assignment.getLvalue()).accept(*this);
+    const_cast<VariableReferenceNode &>(lvalue).accept(*this);
     m_assign_left = false;
-    const_cast<ExpressionNode &>(p_assignment.getExpr()).accept(*this);
-    m_is_binary_condition = false;
-    m_assign_bool = false;
+    visitCoerced(const_cast<ExpressionNode &>(p_assignment.getExpr()), lvalue.getInferredType());
 
     dumpInstructions(m_output_file.get(), riscv_assembly_assignment);
 }
 void CodeGenerator::visit(ReadNode &p_read)
 {
-    constexpr const char *const riscv_assembly_read = "    jal ra, readInt\n"
-                                                      "    lw t0, 0(sp)\n"
+    constexpr const char *const riscv_assembly_read = "    lw t0, 0(sp)\n"
                                                       "    addi sp, sp, 4\n"
                                                       "    sw a0, 0(t0)\n";
     m_is_in_read = true;
     p_read.visitChildNodes(*this);
     m_is_in_read = false;
 
-    dumpInstructions(m_output_file.get(), riscv_assembly_read);
-}
-
-void CodeGenerator::visit(IfNode &p_if)
-{
-    constexpr const char *const riscv_assembly_if = "L%d:\n";
-    int startLabel = 0;
-    int bodyLabel = 0;
-    int endLabel = 0;
-    if (m_label_count != 1)
-        m_label_count++;
-    startLabel = m_label_count++;
-    if (p_if.getBody())
+    if (isRealExpression(p_read.getTarget()))
     {
-        endLabel = m_label_count;
-        jump_label = endLabel;
+        emitRuntimeCall("readReal");
+        dumpInstructions(m_output_file.get(), "    lw t0, 0(sp)\n"
+                                              "    addi sp, sp, 4\n"
+                                              "    fsw fa0, 0(t0)\n");
     }
-    if (p_if.getElseBody())
-    {
-        bodyLabel = m_label_count;
-        jump_label = bodyLabel;
-        m_label_count++;
-        endLabel = m_label_count;
-    }
-    p_if.visitCondition(*this);
-    if (m_is_binary_condition == false)
+    else
     {
-        dumpInstructions(m_output_file.get(),
-                         "    lw t0, 0(sp)\n"
-                         "    addi sp, sp, 4\n");
-        dumpInstructions(m_output_file.get(), "    beqz t0, L%d\n", bodyLabel);
+        emitRuntimeCall("readInt");
+        dumpInstructions(m_output_file.get(), riscv_assembly_read);
     }
-    m_is_binary_condition = false;
-    if (p_if.getBody())
+}
+
+void CodeGenerator::visit(IfNode &p_if)
+{
+    constexpr const char *const riscv_label = "%s%d:\n";
+    constexpr const char *const riscv_branch = "    j %s%d\n";
+
+    // Only the taken branch of a constant condition is reachable.
+    if (const auto *constant = asImmediateOperand(p_if.getCondition()))
     {
-        dumpInstructions(m_output_file.get(), riscv_assembly_if, startLabel);
-        p_if.visitBody(*this);
-        dumpInstructions(m_output_file.get(), "    j L%d\n", endLabel);
+        if (immediateValueOf(*constant))
+            p_if.visitBody(*this);
+        else
+            p_if.visitElseBody(*this);
+        return;
     }
+
+    const int elseLabel = p_if.getElseBody() ? m_label_count++ : 0;
+    const int endLabel = m_label_count++;
+
+    // Fall through into the body when the condition holds.
+    genCondBranch(p_if.getCondition(), 0, elseLabel ? elseLabel : endLabel);
+    p_if.visitBody(*this);
     if (p_if.getElseBody())
     {
-        dumpInstructions(m_output_file.get(), riscv_assembly_if, bodyLabel);
+        if (!alwaysReturns(*p_if.getBody()))
+            dumpInstructions(m_output_file.get(), riscv_branch, m_label_prefix.c_str(), endLabel);
+        dumpInstructions(m_output_file.get(), riscv_label, m_label_prefix.c_str(), elseLabel);
         p_if.visitElseBody(*this);
     }
-    dumpInstructions(m_output_file.get(), riscv_assembly_if, endLabel);
+    dumpInstructions(m_output_file.get(), riscv_label, m_label_prefix.c_str(), endLabel);
 }
 
 void CodeGenerator::visit(WhileNode &p_while)
 {
-    constexpr const char *const riscv_label = "L%d:\n";
-    constexpr const char *const riscv_branch_back = "    j L%d\n";
+    constexpr const char *const riscv_label = "%s%d:\n";
+    constexpr const char *const riscv_branch_back = "    j %s%d\n";
 
-    int startLabel = m_label_count;
-    if (m_label_count == 1)
-    {
-        dumpInstructions(m_output_file.get(), riscv_label, startLabel);
-    }
-    m_label_count++;
+    // The body of `while false` is unreachable.
+    const auto *constant = asImmediateOperand(p_while.getCondition());
+    if (constant && !immediateValueOf(*constant))
+        return;
 
-    jump_label = m_label_count + 1;
-    p_while.visitCondition(*this);
-    dumpInstructions(m_output_file.get(), riscv_label, m_label_count);
+    LoopPreheader preheader;
+    emitLoopPreheader(p_while, preheader);
 
-    if (p_while.getBody())
-    {
-        p_while.visitBody(*this);
-    }
-    dumpInstructions(m_output_file.get(), riscv_branch_back, startLabel);
-    m_label_count++;
-    dumpInstructions(m_output_file.get(), riscv_label, m_label_count);
+    const int startLabel = m_label_count++;
+    const int endLabel = m_label_count++;
+
+    dumpInstructions(m_output_file.get(), riscv_label, m_label_prefix.c_str(), startLabel);
+    genCondBranch(p_while.getCondition(), 0, endLabel);
+    p_while.visitBody(*this);
+    dumpInstructions(m_output_file.get(), riscv_branch_back, m_label_prefix.c_str(), startLabel);
+    dumpInstructions(m_output_file.get(), riscv_label, m_label_prefix.c_str(), endLabel);
+
+    dropHoistedValues(preheader);
 }
 
 void CodeGenerator::visit(ForNode &p_for)
 {
-    constexpr const char *const riscv_label = "L%d:\n";
-    constexpr const char *const riscv_assembly_Push_i_Value = "    lw t0, %d(s0)\n"
-                                                              "    addi sp, sp, -4\n"
-                                                              "    sw t0, 0(sp)\n";
-    constexpr const char *const riscv_assembly_for_condition_check = "    lw t0, 0(sp)\n"
-                                                                     "    addi sp, sp, 4\n"
-                                                                     "    lw t1, 0(sp)\n"
-                                                                     "    addi sp, sp, 4\n"
-                                                                     "    bge t1, t0, L%d\n";
-
-    constexpr const char *const riscv_assembly_for = "    addi t0, s0, %d\n"
-                                                     "    addi sp, sp, -4\n"
-                                                     "    sw t0, 0(sp)\n"
-                                                     "    lw t0, %d(s0)\n"
-                                                     "    addi sp, sp, -4\n"
-                                                     "    sw t0, 0(sp)\n"
-                                                     "    li t0, 1\n"
-                                                     "    addi sp, sp, -4\n"
-                                                     "    sw t0, 0(sp)\n"
-                                                     "    lw t0, 0(sp)\n"
-                                                     "    addi sp, sp, 4\n"
-                                                     "    lw t1, 0(sp)\n"
-                                                     "    addi sp, sp, 4\n"
-                                                     "    add t0, t1, t0\n"
-                                                     "    addi sp, sp, -4\n"
-                                                     "    sw t0, 0(sp)\n"
-                                                     "    lw t0, 0(sp)\n"
-                                                     "    addi sp, sp, 4\n"
-                                                     "    lw t1, 0(sp)\n"
-                                                     "    addi sp, sp, 4\n"
-                                                     "    sw t0, 0(t1)\n"
-                                                     "    j L%d\n";
+    constexpr const char *const riscv_label = "%s%d:\n";
+    constexpr const char *const riscv_assembly_for_condition_check = "    lw t1, %d(s0)\n";
+    constexpr const char *const riscv_assembly_for_branch = "    bge t1, t0, %s%d\n";
+    constexpr const char *const riscv_assembly_for_increment = "    lw t0, %d(s0)\n"
+                                                               "    addi t0, t0, 1\n"
+                                                               "    sw t0, %d(s0)\n"
+                                                               "    j %s%d\n";
 
     // Reconstruct the scope for looking up the symbol entry.
 
-    m_symbol_manager.pushScope(
-        std::move(m_symbol_table_of_scoping_nodes.at(&p_for)));
-    SymbolEntry *symbol_entry = const_cast<SymbolEntry *>(m_symbol_manager.lookup(p_for.getInitStmt().getLvalue().getNameCString()));
+    enterScope(p_for);
+    const SymbolEntry *symbol_entry = p_for.getInitStmt().getLvalue().getSymbolEntry();
     p_for.visitLoopDeclaration(*this);
-    if (m_label_count != 1)
-        m_label_count++;
-    int startLabel = m_label_count++; // startLabel = 6，m_if_label → 7
-    int bodyLabel = m_label_count++;  // bodyLabel  = 7，m_if_label → 8
-    int endLabel = m_label_count++;   // endLabel   = 8，m_if_label → 9
-
-    dumpInstructions(m_output_file.get(), riscv_label, startLabel);
-    dumpInstructions(m_output_file.get(), riscv_assembly_Push_i_Value, symbol_entry->getOffset());
-    p_for.visitLoopCondition(*this);
-    dumpInstructions(m_output_file.get(), riscv_assembly_for_condition_check, endLabel);
-    dumpInstructions(m_output_file.get(), riscv_label, bodyLabel);
+
+    LoopPreheader preheader;
+    emitLoopPreheader(p_for, preheader);
+
+    const int startLabel = m_label_count++;
+    const int endLabel = m_label_count++;
+
+    // The upper bound is always a literal, so the check needs no stack traffic.
+    dumpInstructions(m_output_file.get(), riscv_label, m_label_prefix.c_str(), startLabel);
+    dumpInstructions(m_output_file.get(), riscv_assembly_for_condition_check, getFrameOffset(*symbol_entry));
+    emitLoadImmediate("t0", p_for.getUpperBound().getConstantPtr()->integer());
+    dumpInstructions(m_output_file.get(), riscv_assembly_for_branch, m_label_prefix.c_str(), endLabel);
     p_for.visitLoopBody(*this);
+    emitInductionStep(preheader);
 
-    dumpInstructions(m_output_file.get(), riscv_assembly_for, symbol_entry->getOffset(), symbol_entry->getOffset(), startLabel);
-    dumpInstructions(m_output_file.get(), riscv_label, endLabel);
+    dumpInstructions(m_output_file.get(), riscv_assembly_for_increment, getFrameOffset(*symbol_entry), getFrameOffset(*symbol_entry), m_label_prefix.c_str(), startLabel);
+    dumpInstructions(m_output_file.get(), riscv_label, m_label_prefix.c_str(), endLabel);
+    dropHoistedValues(preheader);
 
     // Remove the entries in the hash table
-    m_symbol_manager.popScope();
+    leaveScope(p_for);
+}
+
+bool CodeGenerator::emitTailCall(const ReturnNode &p_return)
+{
+    constexpr const char *const riscv_assembly_pop = "    lw t0, 0(sp)\n"
+                                                     "    addi sp, sp, 4\n";
+
+    const auto *invocation = dynamic_cast<const FunctionInvocationNode *>(&p_return.getReturnValue());
+    if (!invocation || m_inline_depth > 0 || !m_current_function ||
+        m_inline_analyzer.getInlineTarget(invocation->getName()))
+        return false;
+
+    // The result is passed through as is, so it needs no conversion, and the
+    // arguments of another callee have to fit in registers.
+    const SymbolEntry *callee = invocation->getSymbolEntry();
+    const auto &arguments = invocation->getArguments();
+    const auto parameter_types = parameterTypesOf(*callee->getAttribute().parameters());
+    const auto registers = argumentRegistersOf(parameter_types);
+    const bool is_self_call = invocation->getName() == m_current_function->getName();
+    if (callee->getTypePtr()->isReal() != m_return_type->isReal())
+        return false;
+    if (!is_self_call && std::count(registers.begin(), registers.end(), ""))
+        return false;
+
+    // All arguments are evaluated before any parameter is overwritten.
+    m_is_in_function_invocation = true;
+    for (size_t i = 0; i < arguments.size(); ++i)
+        visitCoerced(*arguments[i], parameter_types[i]);
+    m_is_in_function_invocation = false;
+
+    if (is_self_call)
+    {
+        for (int i = int(arguments.size()) - 1; i >= 0; i--)
+        {
+            dumpInstructions(m_output_file.get(), riscv_assembly_pop);
+            dumpInstructions(m_output_file.get(), "    sw t0, %d(s0)\n", m_parameter_offsets[i]);
+        }
+        // Statements leave nothing on the stack, so sp is already back to
+        // where the body started.
+        dumpInstructions(m_output_file.get(), "    j %s%d\n", m_label_prefix.c_str(), m_tail_call_label);
+        return true;
+    }
+
+    for (int i = int(arguments.size()) - 1; i >= 0; i--)
+        dumpInstructions(m_output_file.get(), "    %s %s, 0(sp)\n"
+                                              "    addi sp, sp, 4\n",
+                         isFloatRegister(registers[i]) ? "flw" : "lw",
+                         registers[i].c_str());
+    emitFrameTeardown();
+    dumpInstructions(m_output_file.get(), "    j %s\n", invocation->getNameCString());
+    return true;
 }
 
 void CodeGenerator::visit(ReturnNode &p_return)
 {
-    p_return.visitChildNodes(*this);
+    if (emitTailCall(p_return))
+        return;
+
+    visitCoerced(const_cast<ExpressionNode &>(p_return.getReturnValue()), m_return_type);
+    if (m_inline_depth > 0)
+        return;
 
     constexpr const char *const riscv_assembly_return = "    lw a0, 0(sp)\n"
-                                                        "    addi sp, sp, 4\n"
-                                                        "    mv a0, t0\n"
-                                                        "    lw ra, 124(sp)\n"
-                                                        "    lw s0, 120(sp)\n"
-                                                        "    addi sp, sp, 128\n"
-                                                        "    jr ra\n";
-
-    dumpInstructions(m_output_file.get(), riscv_assembly_return);
+                                                        "    addi sp, sp, 4\n";
+
+    if (m_return_type && m_return_type->isReal())
+        dumpInstructions(m_output_file.get(), "    flw fa0, 0(sp)\n"
+                                              "    addi sp, sp, 4\n");
+    else
+        dumpInstructions(m_output_file.get(), riscv_assembly_return);
+    emitFrameTeardown();
+    dumpInstructions(m_output_file.get(), "    jr ra\n");
 }
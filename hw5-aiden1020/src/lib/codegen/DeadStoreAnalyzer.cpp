@@ -0,0 +1,85 @@
+#include "codegen/DeadStoreAnalyzer.hpp"
+#include "visitor/AstNodeInclude.hpp"
+
+void DeadStoreAnalyzer::analyze(AstNode &p_body) {
+    m_read_names.clear();
+    p_body.accept(*this);
+}
+
+bool DeadStoreAnalyzer::hasSideEffects(const ExpressionNode &p_expr) {
+    if (dynamic_cast<const FunctionInvocationNode *>(&p_expr)) {
+        return true;
+    }
+    if (const auto *ref = dynamic_cast<const VariableReferenceNode *>(&p_expr)) {
+        for (const auto &index : ref->getIndices()) {
+            if (hasSideEffects(*index)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    if (const auto *bin_op = dynamic_cast<const BinaryOperatorNode *>(&p_expr)) {
+        return hasSideEffects(bin_op->getLeftOperand()) ||
+               hasSideEffects(bin_op->getRightOperand());
+    }
+    if (const auto *un_op = dynamic_cast<const UnaryOperatorNode *>(&p_expr)) {
+        return hasSideEffects(un_op->getOperand());
+    }
+    return false;
+}
+
+void DeadStoreAnalyzer::visit(DeclNode &p_decl) {
+    // Declarations only store their initial values.
+}
+
+void DeadStoreAnalyzer::visit(CompoundStatementNode &p_compound_statement) {
+    p_compound_statement.visitChildNodes(*this);
+}
+
+void DeadStoreAnalyzer::visit(PrintNode &p_print) {
+    p_print.visitChildNodes(*this);
+}
+
+void DeadStoreAnalyzer::visit(BinaryOperatorNode &p_bin_op) {
+    p_bin_op.visitChildNodes(*this);
+}
+
+void DeadStoreAnalyzer::visit(UnaryOperatorNode &p_un_op) {
+    p_un_op.visitChildNodes(*this);
+}
+
+void DeadStoreAnalyzer::visit(FunctionInvocationNode &p_func_invocation) {
+    p_func_invocation.visitChildNodes(*this);
+}
+
+void DeadStoreAnalyzer::visit(VariableReferenceNode &p_variable_ref) {
+    m_read_names.insert(p_variable_ref.getName());
+    p_variable_ref.visitChildNodes(*this);
+}
+
+void DeadStoreAnalyzer::visit(AssignmentNode &p_assignment) {
+    // The lvalue itself is written, but its indices are read.
+    const_cast<VariableReferenceNode &>(p_assignment.getLvalue())
+        .visitChildNodes(*this);
+    const_cast<ExpressionNode &>(p_assignment.getExpr()).accept(*this);
+}
+
+void DeadStoreAnalyzer::visit(ReadNode &p_read) {
+    const_cast<VariableReferenceNode &>(p_read.getTarget()).visitChildNodes(*this);
+}
+
+void DeadStoreAnalyzer::visit(IfNode &p_if) {
+    p_if.visitChildNodes(*this);
+}
+
+void DeadStoreAnalyzer::visit(WhileNode &p_while) {
+    p_while.visitChildNodes(*this);
+}
+
+void DeadStoreAnalyzer::visit(ForNode &p_for) {
+    p_for.visitChildNodes(*this);
+}
+
+void DeadStoreAnalyzer::visit(ReturnNode &p_return) {
+    p_return.visitChildNodes(*this);
+}
@@ -0,0 +1,104 @@
+#include "codegen/FunctionCache.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+
+// An entry is laid out as
+//
+//   <number of reals>
+//   <bit pattern of each real, one per line>
+//   <number of strings>
+//   <length of each string>
+//   <contents of the string>
+//   <length of the assembly>
+//   <assembly>
+
+namespace {
+using File = std::unique_ptr<FILE, decltype(&fclose)>;
+
+bool readBytes(FILE *p_in, std::string &p_bytes) {
+    size_t size = 0;
+    if (fscanf(p_in, "%zu", &size) != 1 || fgetc(p_in) != '\n') {
+        return false;
+    }
+    p_bytes.resize(size);
+    return fread(&p_bytes[0], 1, size, p_in) == size;
+}
+
+void writeBytes(FILE *p_out, const std::string &p_bytes) {
+    fprintf(p_out, "%zu\n", p_bytes.size());
+    fwrite(p_bytes.data(), 1, p_bytes.size(), p_out);
+}
+} // namespace
+
+FunctionCache::FunctionCache(const std::string &p_directory)
+    : m_directory(p_directory) {
+    for (size_t slash = m_directory.find('/', 1); slash != std::string::npos;
+         slash = m_directory.find('/', slash + 1)) {
+        mkdir(m_directory.substr(0, slash).c_str(), 0755);
+    }
+    mkdir(m_directory.c_str(), 0755);
+}
+
+std::string FunctionCache::pathOf(uint64_t p_key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016" PRIx64 ".s", p_key);
+    return m_directory + name;
+}
+
+bool FunctionCache::load(uint64_t p_key, CachedFunction &p_function) const {
+    File in(fopen(pathOf(p_key).c_str(), "rb"), &fclose);
+    if (!in) {
+        return false;
+    }
+
+    size_t num_reals = 0;
+    if (fscanf(in.get(), "%zu", &num_reals) != 1) {
+        return false;
+    }
+    p_function.m_real_constants.resize(num_reals);
+    for (auto &bits : p_function.m_real_constants) {
+        if (fscanf(in.get(), "%" SCNx32, &bits) != 1) {
+            return false;
+        }
+    }
+
+    size_t num_strings = 0;
+    if (fscanf(in.get(), "%zu", &num_strings) != 1) {
+        return false;
+    }
+    p_function.m_string_constants.resize(num_strings);
+    for (auto &string : p_function.m_string_constants) {
+        if (!readBytes(in.get(), string)) {
+            return false;
+        }
+    }
+    return readBytes(in.get(), p_function.m_assembly);
+}
+
+void FunctionCache::store(uint64_t p_key,
+                          const CachedFunction &p_function) const {
+    const std::string path = pathOf(p_key);
+    const std::string temporary_path =
+        path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        File out(fopen(temporary_path.c_str(), "wb"), &fclose);
+        if (!out) {
+            return;
+        }
+        fprintf(out.get(), "%zu\n", p_function.m_real_constants.size());
+        for (const auto bits : p_function.m_real_constants) {
+            fprintf(out.get(), "%08" PRIx32 "\n", bits);
+        }
+        fprintf(out.get(), "%zu\n", p_function.m_string_constants.size());
+        for (const auto &string : p_function.m_string_constants) {
+            writeBytes(out.get(), string);
+        }
+        writeBytes(out.get(), p_function.m_assembly);
+    }
+    rename(temporary_path.c_str(), path.c_str());
+}
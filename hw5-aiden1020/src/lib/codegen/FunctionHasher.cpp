@@ -0,0 +1,109 @@
+#include "codegen/FunctionHasher.hpp"
+#include "visitor/AstNodeInclude.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+uint64_t FunctionHasher::hash(AstNode &p_node) {
+    m_hash = kOffsetBasis;
+    m_callees.clear();
+    p_node.accept(*this);
+    return m_hash;
+}
+
+uint64_t FunctionHasher::hashString(const std::string &p_string,
+                                    uint64_t p_seed) {
+    constexpr uint64_t kPrime = 0x100000001b3ULL;
+    uint64_t hash = p_seed;
+    for (const char c : p_string) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= kPrime;
+    }
+    return hash;
+}
+
+std::string FunctionHasher::keyOf(const Constant &p_constant) {
+    if (!p_constant.getTypePtr()->isReal()) {
+        return p_constant.getConstantValueCString();
+    }
+    const double value = p_constant.real();
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    char key[17];
+    snprintf(key, sizeof(key), "%016" PRIx64, bits);
+    return key;
+}
+
+void FunctionHasher::add(const std::string &p_token) {
+    m_hash = hashString(p_token, m_hash);
+    m_hash = hashString(std::string(1, '\0'), m_hash);
+}
+
+template <typename NodeT>
+void FunctionHasher::addNode(const std::string &p_token, NodeT &p_node) {
+    add(p_token);
+    p_node.visitChildNodes(*this);
+    add(")");
+}
+
+void FunctionHasher::visit(ProgramNode &p_program) {
+    addNode("program " + p_program.getName(), p_program);
+}
+
+void FunctionHasher::visit(DeclNode &p_decl) { addNode("decl", p_decl); }
+
+void FunctionHasher::visit(VariableNode &p_variable) {
+    addNode("variable " + p_variable.getName() + " " +
+                p_variable.getTypeCString(),
+            p_variable);
+}
+
+void FunctionHasher::visit(ConstantValueNode &p_constant_value) {
+    add(std::string{"constant "} +
+        p_constant_value.getTypePtr()->getPTypeCString() + " " +
+        keyOf(*p_constant_value.getConstantPtr()));
+}
+
+void FunctionHasher::visit(FunctionNode &p_function) {
+    addNode("function " + p_function.getName() + " " +
+                p_function.getTypePtr()->getPTypeCString(),
+            p_function);
+}
+
+void FunctionHasher::visit(CompoundStatementNode &p_compound_statement) {
+    addNode("compound", p_compound_statement);
+}
+
+void FunctionHasher::visit(PrintNode &p_print) { addNode("print", p_print); }
+
+void FunctionHasher::visit(BinaryOperatorNode &p_bin_op) {
+    addNode(std::string{"binary "} + p_bin_op.getOpCString(), p_bin_op);
+}
+
+void FunctionHasher::visit(UnaryOperatorNode &p_un_op) {
+    addNode(std::string{"unary "} + p_un_op.getOpCString(), p_un_op);
+}
+
+void FunctionHasher::visit(FunctionInvocationNode &p_func_invocation) {
+    m_callees.insert(p_func_invocation.getName());
+    addNode("invocation " + p_func_invocation.getName(), p_func_invocation);
+}
+
+void FunctionHasher::visit(VariableReferenceNode &p_variable_ref) {
+    addNode("reference " + p_variable_ref.getName(), p_variable_ref);
+}
+
+void FunctionHasher::visit(AssignmentNode &p_assignment) {
+    addNode("assignment", p_assignment);
+}
+
+void FunctionHasher::visit(ReadNode &p_read) { addNode("read", p_read); }
+
+void FunctionHasher::visit(IfNode &p_if) { addNode("if", p_if); }
+
+void FunctionHasher::visit(WhileNode &p_while) { addNode("while", p_while); }
+
+void FunctionHasher::visit(ForNode &p_for) { addNode("for", p_for); }
+
+void FunctionHasher::visit(ReturnNode &p_return) { addNode("return", p_return); }
@@ -0,0 +1,188 @@
+#include "codegen/InlineAnalyzer.hpp"
+#include "visitor/AstNodeInclude.hpp"
+
+#include <vector>
+
+const FunctionNode *
+InlineAnalyzer::getInlineTarget(const std::string &p_name) const {
+    auto it = m_functions.find(p_name);
+    if (it == m_functions.end()) {
+        return nullptr;
+    }
+    const auto &info = it->second;
+    if (!info.m_function || info.m_has_invocation) {
+        return nullptr;
+    }
+
+    const auto &statements = info.m_function->getBody()->getStatements();
+    const bool ends_with_return =
+        !statements.empty() &&
+        dynamic_cast<const ReturnNode *>(statements.back().get());
+    if (info.m_function->getTypePtr()->isVoid()) {
+        if (info.m_num_returns != 0) {
+            return nullptr;
+        }
+    } else if (info.m_num_returns != 1 || !ends_with_return) {
+        return nullptr;
+    }
+
+    if (info.m_size <= kAlwaysInlineSize ||
+        (info.m_size <= kMaxInlineSize && info.m_num_call_sites == 1)) {
+        return info.m_function;
+    }
+    return nullptr;
+}
+
+bool InlineAnalyzer::hasOutOfLineCall(const std::string &p_name) const {
+    auto it = m_functions.find(p_name);
+    if (it == m_functions.end()) {
+        return false;
+    }
+    if (it->second.m_has_runtime_call) {
+        return true;
+    }
+    // Inlined callees are leaves, so their own calls are to the runtime only.
+    for (const auto &callee : it->second.m_callees) {
+        if (!getInlineTarget(callee) ||
+            m_functions.at(callee).m_has_runtime_call) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::set<std::string>
+InlineAnalyzer::collectLiveFunctions(const std::string &p_program_name) const {
+    std::set<std::string> live;
+    std::vector<std::string> worklist{p_program_name};
+    while (!worklist.empty()) {
+        auto it = m_functions.find(worklist.back());
+        worklist.pop_back();
+        if (it == m_functions.end()) {
+            continue;
+        }
+        for (const auto &callee : it->second.m_callees) {
+            if (!getInlineTarget(callee) && live.insert(callee).second) {
+                worklist.push_back(callee);
+            }
+        }
+    }
+    return live;
+}
+
+size_t InlineAnalyzer::getSize(const std::string &p_name) const {
+    auto it = m_functions.find(p_name);
+    return it == m_functions.end() ? 0 : it->second.m_size;
+}
+
+void InlineAnalyzer::visit(ProgramNode &p_program) {
+    for (const auto &decl_node : p_program.getDeclNodes()) {
+        decl_node->accept(*this);
+    }
+    for (const auto &func_node : p_program.getFuncNodes()) {
+        func_node->accept(*this);
+    }
+
+    // The main body is recorded under the program name, which no function can
+    // have, only for `hasOutOfLineCall`.
+    m_current_function = &m_functions[p_program.getName()];
+    const_cast<CompoundStatementNode &>(p_program.getBody()).accept(*this);
+    m_current_function = nullptr;
+}
+
+void InlineAnalyzer::visit(DeclNode &p_decl) {
+    p_decl.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(VariableNode &p_variable) {
+    p_variable.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(ConstantValueNode &p_constant_value) {
+    count();
+}
+
+void InlineAnalyzer::visit(FunctionNode &p_function) {
+    // Declarations without a body only contribute their name.
+    auto &info = m_functions[p_function.getName()];
+    if (!p_function.getBody()) {
+        return;
+    }
+    info.m_function = &p_function;
+
+    m_current_function = &info;
+    p_function.visitBodyChildNodes(*this);
+    m_current_function = nullptr;
+}
+
+void InlineAnalyzer::visit(CompoundStatementNode &p_compound_statement) {
+    p_compound_statement.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(PrintNode &p_print) {
+    count();
+    markRuntimeCall();
+    p_print.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(BinaryOperatorNode &p_bin_op) {
+    count();
+    if (p_bin_op.getInferredType() && p_bin_op.getInferredType()->isString()) {
+        markRuntimeCall();
+    }
+    p_bin_op.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(UnaryOperatorNode &p_un_op) {
+    count();
+    p_un_op.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(FunctionInvocationNode &p_func_invocation) {
+    count();
+    ++m_functions[p_func_invocation.getName()].m_num_call_sites;
+    if (m_current_function) {
+        m_current_function->m_has_invocation = true;
+        m_current_function->m_callees.insert(p_func_invocation.getName());
+    }
+    p_func_invocation.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(VariableReferenceNode &p_variable_ref) {
+    count();
+    p_variable_ref.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(AssignmentNode &p_assignment) {
+    count();
+    p_assignment.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(ReadNode &p_read) {
+    count();
+    markRuntimeCall();
+    p_read.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(IfNode &p_if) {
+    count();
+    p_if.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(WhileNode &p_while) {
+    count();
+    p_while.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(ForNode &p_for) {
+    count();
+    p_for.visitChildNodes(*this);
+}
+
+void InlineAnalyzer::visit(ReturnNode &p_return) {
+    count();
+    if (m_current_function) {
+        ++m_current_function->m_num_returns;
+    }
+    p_return.visitChildNodes(*this);
+}
@@ -0,0 +1,175 @@
+#include "codegen/LocalValueNumbering.hpp"
+#include "codegen/DeadStoreAnalyzer.hpp"
+#include "codegen/FunctionHasher.hpp"
+#include "visitor/AstNodeInclude.hpp"
+
+#include <utility>
+
+void LocalValueNumbering::analyze(const std::vector<const AstNode *> &p_block) {
+    for (const auto *statement : p_block) {
+        numberStatement(*statement);
+    }
+
+    std::map<int, int> num_occurrences;
+    for (const auto &occurrence : m_occurrences) {
+        ++num_occurrences[occurrence.m_value_number];
+    }
+
+    std::map<int, const ExpressionNode *> first_occurrences;
+    for (const auto &occurrence : m_occurrences) {
+        if (num_occurrences[occurrence.m_value_number] < 2) {
+            continue;
+        }
+        auto inserted = first_occurrences.emplace(occurrence.m_value_number,
+                                                  occurrence.m_expr);
+        if (inserted.second) {
+            m_saved_exprs.push_back(occurrence.m_expr);
+        } else {
+            m_reused_exprs.emplace(occurrence.m_expr, inserted.first->second);
+        }
+    }
+}
+
+void LocalValueNumbering::numberStatement(const AstNode &p_statement) {
+    if (const auto *assignment = dynamic_cast<const AssignmentNode *>(&p_statement)) {
+        // The address of the lvalue is computed before the expression.
+        for (const auto &index : assignment->getLvalue().getIndices()) {
+            numberExpression(*index);
+        }
+        numberExpression(assignment->getExpr());
+        invalidate(assignment->getLvalue());
+    } else if (const auto *read = dynamic_cast<const ReadNode *>(&p_statement)) {
+        for (const auto &index : read->getTarget().getIndices()) {
+            numberExpression(*index);
+        }
+        invalidate(read->getTarget());
+    } else if (const auto *print = dynamic_cast<const PrintNode *>(&p_statement)) {
+        numberExpression(print->getTarget());
+    } else if (const auto *ret = dynamic_cast<const ReturnNode *>(&p_statement)) {
+        numberExpression(ret->getReturnValue());
+    } else if (const auto *expr = dynamic_cast<const ExpressionNode *>(&p_statement)) {
+        numberExpression(*expr);
+    }
+}
+
+int LocalValueNumbering::numberExpression(const ExpressionNode &p_expr) {
+    if (m_opaque_exprs.count(&p_expr)) {
+        return newUniqueValue();
+    }
+
+    if (const auto *constant = dynamic_cast<const ConstantValueNode *>(&p_expr)) {
+        return valueNumberOf(std::string{"c"} +
+                             constant->getTypePtr()->getPTypeCString() + ":" +
+                             FunctionHasher::keyOf(*constant->getConstantPtr()));
+    }
+
+    if (const auto *ref = dynamic_cast<const VariableReferenceNode *>(&p_expr)) {
+        std::string key = "v" + versionedName(*ref);
+        if (ref->getIndices().empty()) {
+            return valueNumberOf(key);
+        }
+        for (const auto &index : ref->getIndices()) {
+            key += "[" + std::to_string(numberExpression(*index)) + "]";
+        }
+        const int value_number = valueNumberOf(key);
+        addOccurrence(p_expr, value_number);
+        return value_number;
+    }
+
+    if (const auto *bin_op = dynamic_cast<const BinaryOperatorNode *>(&p_expr)) {
+        // The code generator branches around the right operand of `and` and
+        // `or` if evaluating it has side effects.
+        const bool is_conditional =
+            (bin_op->getOp() == Operator::kAndOp ||
+             bin_op->getOp() == Operator::kOrOp) &&
+            DeadStoreAnalyzer::hasSideEffects(bin_op->getRightOperand());
+        int left = numberExpression(bin_op->getLeftOperand());
+        m_conditional_depth += is_conditional;
+        int right = numberExpression(bin_op->getRightOperand());
+        m_conditional_depth -= is_conditional;
+        switch (bin_op->getOp()) {
+        case Operator::kPlusOp:
+        case Operator::kMultiplyOp:
+        case Operator::kAndOp:
+        case Operator::kOrOp:
+        case Operator::kEqualOp:
+        case Operator::kNotEqualOp:
+            if (left > right) {
+                std::swap(left, right);
+            }
+            break;
+        default:
+            break;
+        }
+        const int value_number = valueNumberOf(
+            "b" + std::to_string(static_cast<int>(bin_op->getOp())) + "(" +
+            std::to_string(left) + "," + std::to_string(right) + ")");
+        addOccurrence(p_expr, value_number);
+        return value_number;
+    }
+
+    if (const auto *un_op = dynamic_cast<const UnaryOperatorNode *>(&p_expr)) {
+        const int operand = numberExpression(un_op->getOperand());
+        const int value_number = valueNumberOf(
+            "u" + std::to_string(static_cast<int>(un_op->getOp())) + "(" +
+            std::to_string(operand) + ")");
+        addOccurrence(p_expr, value_number);
+        return value_number;
+    }
+
+    if (const auto *invocation = dynamic_cast<const FunctionInvocationNode *>(&p_expr)) {
+        for (const auto &argument : invocation->getArguments()) {
+            numberExpression(*argument);
+        }
+        // The callee may assign to any global and to the arrays passed to it.
+        ++m_call_epoch;
+        ++m_array_epoch;
+        return newUniqueValue();
+    }
+
+    return newUniqueValue();
+}
+
+int LocalValueNumbering::valueNumberOf(const std::string &p_key) {
+    auto it = m_value_numbers.find(p_key);
+    if (it != m_value_numbers.end()) {
+        return it->second;
+    }
+    const int value_number = newUniqueValue();
+    m_value_numbers.emplace(p_key, value_number);
+    return value_number;
+}
+
+int LocalValueNumbering::newUniqueValue() {
+    return m_num_unique_values++;
+}
+
+void LocalValueNumbering::addOccurrence(const ExpressionNode &p_expr,
+                                        int p_value_number) {
+    if (m_conditional_depth == 0) {
+        m_occurrences.push_back({&p_expr, p_value_number});
+    }
+}
+
+std::string
+LocalValueNumbering::versionedName(const VariableReferenceNode &p_ref) const {
+    auto it = m_versions.find(p_ref.getName());
+    std::string name = p_ref.getName() + "#" +
+                       std::to_string(it == m_versions.end() ? 0 : it->second);
+
+    const auto *entry = p_ref.getSymbolEntry();
+    if (entry && entry->getLevel() == 0) {
+        name += "@" + std::to_string(m_call_epoch);
+    }
+    if (entry && !entry->getTypePtr()->getDimensions().empty()) {
+        name += "%" + std::to_string(m_array_epoch);
+    }
+    return name;
+}
+
+void LocalValueNumbering::invalidate(const VariableReferenceNode &p_target) {
+    ++m_versions[p_target.getName()];
+    if (!p_target.getIndices().empty()) {
+        ++m_array_epoch;
+    }
+}
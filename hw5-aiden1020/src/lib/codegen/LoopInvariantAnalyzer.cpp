@@ -0,0 +1,148 @@
+#include "codegen/LoopInvariantAnalyzer.hpp"
+#include "visitor/AstNodeInclude.hpp"
+
+
+void LoopInvariantAnalyzer::analyze(AstNode &p_loop) {
+    if (const auto *for_node = dynamic_cast<const ForNode *>(&p_loop)) {
+        m_induction_var = for_node->getInitStmt().getLvalue().getName();
+    }
+
+    m_phase = Phase::kCollectModified;
+    p_loop.accept(*this);
+
+    m_phase = Phase::kFindInvariants;
+    p_loop.accept(*this);
+}
+
+bool LoopInvariantAnalyzer::isGlobal(const VariableReferenceNode &p_ref) const {
+    // Bound to the declaration in scope, so a local declared inside the loop
+    // is told from a global of the same name.
+    const auto *entry = p_ref.getSymbolEntry();
+    return entry && entry->getLevel() == 0;
+}
+
+bool LoopInvariantAnalyzer::isInvariant(const ExpressionNode &p_expr) const {
+    if (dynamic_cast<const ConstantValueNode *>(&p_expr)) {
+        return true;
+    }
+    if (const auto *ref = dynamic_cast<const VariableReferenceNode *>(&p_expr)) {
+        if (!ref->getIndices().empty() || m_modified_names.count(ref->getName())) {
+            return false;
+        }
+        return !(m_has_invocation && isGlobal(*ref));
+    }
+    if (const auto *bin_op = dynamic_cast<const BinaryOperatorNode *>(&p_expr)) {
+        return isInvariant(bin_op->getLeftOperand()) &&
+               isInvariant(bin_op->getRightOperand());
+    }
+    if (const auto *un_op = dynamic_cast<const UnaryOperatorNode *>(&p_expr)) {
+        return isInvariant(un_op->getOperand());
+    }
+    // Function invocations may have side effects.
+    return false;
+}
+
+bool LoopInvariantAnalyzer::isInductionReference(
+    const VariableReferenceNode &p_ref) const {
+    const auto &indices = p_ref.getIndices();
+    if (m_induction_var.empty() || indices.empty() ||
+        m_declared_names.count(p_ref.getName())) {
+        return false;
+    }
+    const auto *last =
+        dynamic_cast<const VariableReferenceNode *>(indices.back().get());
+    if (!last || !last->getIndices().empty() ||
+        last->getName() != m_induction_var) {
+        return false;
+    }
+    for (auto it = indices.begin(); it + 1 != indices.end(); ++it) {
+        if (!isInvariant(**it)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LoopInvariantAnalyzer::visit(DeclNode &p_decl) {
+    p_decl.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(VariableNode &p_variable) {
+    // A variable declared in the loop is (re)initialized on every iteration.
+    if (m_phase == Phase::kCollectModified) {
+        m_declared_names.insert(p_variable.getName());
+        m_modified_names.insert(p_variable.getName());
+    }
+}
+
+void LoopInvariantAnalyzer::visit(CompoundStatementNode &p_compound_statement) {
+    p_compound_statement.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(PrintNode &p_print) {
+    p_print.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(BinaryOperatorNode &p_bin_op) {
+    if (m_phase == Phase::kFindInvariants && isInvariant(p_bin_op)) {
+        m_invariant_exprs.push_back(&p_bin_op);
+        return;
+    }
+    p_bin_op.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(UnaryOperatorNode &p_un_op) {
+    if (m_phase == Phase::kFindInvariants && isInvariant(p_un_op)) {
+        m_invariant_exprs.push_back(&p_un_op);
+        return;
+    }
+    p_un_op.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(FunctionInvocationNode &p_func_invocation) {
+    if (m_phase == Phase::kCollectModified) {
+        m_has_invocation = true;
+    }
+    p_func_invocation.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(VariableReferenceNode &p_variable_ref) {
+    if (m_phase == Phase::kFindInvariants && isGlobal(p_variable_ref)) {
+        m_global_names.insert(p_variable_ref.getName());
+    }
+    if (m_phase == Phase::kFindInvariants && isInductionReference(p_variable_ref)) {
+        m_induction_refs.push_back(&p_variable_ref);
+        return;
+    }
+    p_variable_ref.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(AssignmentNode &p_assignment) {
+    if (m_phase == Phase::kCollectModified) {
+        m_modified_names.insert(p_assignment.getLvalue().getName());
+    }
+    p_assignment.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(ReadNode &p_read) {
+    if (m_phase == Phase::kCollectModified) {
+        m_modified_names.insert(p_read.getTarget().getName());
+    }
+    p_read.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(IfNode &p_if) {
+    p_if.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(WhileNode &p_while) {
+    p_while.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(ForNode &p_for) {
+    p_for.visitChildNodes(*this);
+}
+
+void LoopInvariantAnalyzer::visit(ReturnNode &p_return) {
+    p_return.visitChildNodes(*this);
+}
@@ -0,0 +1,962 @@
+#include "sema/CheckedModule.hpp"
+#include "visitor/AstNodeInclude.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// A module file is laid out as
+//
+//   "PMOD" <version>
+//   <source path>
+//   <program node>
+//   <number of imported declarations> <decl node>...
+//   <number of imported functions> <function node>...
+//   <number of symbol tables>
+//     <scoping node> <number of entries> (<declaring node> <kind> <level>)...
+//   <offset of each node as 4 bytes, little endian>
+//   <offset of the first of them> <number of nodes> "PIDX"  (4 bytes each)
+//
+// A node starts with its kind, line and column, followed by its own fields
+// and then its children in the order of `visitChildNodes`. An expression has
+// its inferred type right before its children. A declaration owns its
+// variables and their (shared) constant, which are numbered right after it.
+
+namespace {
+constexpr char kMagic[] = "PMOD";
+constexpr char kIndexMagic[] = "PIDX";
+constexpr uint64_t kVersion = 1;
+/// Stands for a null type.
+constexpr uint8_t kNoType = 0xff;
+
+enum class NodeKind : uint8_t {
+    kProgram,
+    kDecl,
+    kConstantValue,
+    kFunction,
+    kCompoundStatement,
+    kPrint,
+    kBinaryOperator,
+    kUnaryOperator,
+    kFunctionInvocation,
+    kVariableReference,
+    kAssignment,
+    kRead,
+    kIf,
+    kWhile,
+    kFor,
+    kReturn
+};
+
+class ModuleWriter final : public AstNodeVisitor {
+  private:
+    std::string m_bytes;
+    std::vector<uint32_t> m_node_offsets;
+    std::unordered_map<const AstNode *, uint64_t> m_node_ids;
+    /// The name of a symbol entry refers to the name of its declaring node.
+    std::unordered_map<const std::string *, uint64_t> m_declaring_node_ids;
+
+  public:
+    ~ModuleWriter() = default;
+    ModuleWriter() = default;
+
+    const std::string &getBytes() const { return m_bytes; }
+
+    void writeVarint(uint64_t p_value) {
+        while (p_value >= 0x80) {
+            m_bytes += static_cast<char>((p_value & 0x7f) | 0x80);
+            p_value >>= 7;
+        }
+        m_bytes += static_cast<char>(p_value);
+    }
+    void writeSigned(int64_t p_value) {
+        // Zigzag, so that small negative values stay short.
+        writeVarint((static_cast<uint64_t>(p_value) << 1) ^
+                    static_cast<uint64_t>(p_value >> 63));
+    }
+    void writeString(const std::string &p_string) {
+        writeVarint(p_string.size());
+        m_bytes += p_string;
+    }
+    void writeMagic(const char *p_magic) { m_bytes.append(p_magic, 4); }
+    void writeFixed32(uint32_t p_value) {
+        for (int i = 0; i < 4; ++i) {
+            m_bytes += static_cast<char>(p_value >> (8 * i));
+        }
+    }
+
+    /// @return `false` if an entry is declared by a node not in the module.
+    bool writeSymbolTables(const CheckedModule::SymbolTables &p_symbol_tables);
+    void writeIndex();
+
+    void visit(ProgramNode &p_program) override;
+    void visit(DeclNode &p_decl) override;
+    void visit(VariableNode &p_variable) override {}
+    void visit(ConstantValueNode &p_constant_value) override;
+    void visit(FunctionNode &p_function) override;
+    void visit(CompoundStatementNode &p_compound_statement) override;
+    void visit(PrintNode &p_print) override;
+    void visit(BinaryOperatorNode &p_bin_op) override;
+    void visit(UnaryOperatorNode &p_un_op) override;
+    void visit(FunctionInvocationNode &p_func_invocation) override;
+    void visit(VariableReferenceNode &p_variable_ref) override;
+    void visit(AssignmentNode &p_assignment) override;
+    void visit(ReadNode &p_read) override;
+    void visit(IfNode &p_if) override;
+    void visit(WhileNode &p_while) override;
+    void visit(ForNode &p_for) override;
+    void visit(ReturnNode &p_return) override;
+
+  private:
+    void beginNode(const AstNode &p_node, NodeKind p_kind);
+    /// @brief Numbers a node that is written as part of another one.
+    void numberNode(const AstNode &p_node);
+    void writeType(const PType *p_type);
+    void writeConstant(const Constant &p_constant);
+};
+
+void ModuleWriter::numberNode(const AstNode &p_node) {
+    m_node_ids.emplace(&p_node, m_node_offsets.size());
+    m_node_offsets.push_back(static_cast<uint32_t>(m_bytes.size()));
+}
+
+void ModuleWriter::beginNode(const AstNode &p_node, NodeKind p_kind) {
+    numberNode(p_node);
+    m_bytes += static_cast<char>(p_kind);
+    writeVarint(p_node.getLocation().line);
+    writeVarint(p_node.getLocation().col);
+}
+
+void ModuleWriter::writeType(const PType *p_type) {
+    if (!p_type) {
+        m_bytes += static_cast<char>(kNoType);
+        return;
+    }
+    m_bytes += static_cast<char>(p_type->getPrimitiveType());
+    writeVarint(p_type->getDimensions().size());
+    for (const auto dim : p_type->getDimensions()) {
+        writeVarint(dim);
+    }
+}
+
+void ModuleWriter::writeConstant(const Constant &p_constant) {
+    writeType(p_constant.getTypePtr());
+    switch (p_constant.getTypePtr()->getPrimitiveType()) {
+    case PType::PrimitiveTypeEnum::kIntegerType:
+        writeSigned(p_constant.integer());
+        break;
+    case PType::PrimitiveTypeEnum::kRealType: {
+        uint64_t bits = 0;
+        const double real = p_constant.real();
+        memcpy(&bits, &real, sizeof(bits));
+        writeVarint(bits);
+        break;
+    }
+    case PType::PrimitiveTypeEnum::kBoolType:
+        writeVarint(p_constant.boolean());
+        break;
+    case PType::PrimitiveTypeEnum::kStringType:
+        writeString(p_constant.getConstantValueCString());
+        break;
+    default:
+        break;
+    }
+}
+
+void ModuleWriter::visit(ProgramNode &p_program) {
+    beginNode(p_program, NodeKind::kProgram);
+    m_declaring_node_ids.emplace(&p_program.getName(), m_node_ids[&p_program]);
+    writeString(p_program.getName());
+    writeType(p_program.getTypePtr());
+    writeVarint(p_program.getDeclNodes().size());
+    writeVarint(p_program.getFuncNodes().size());
+    p_program.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(DeclNode &p_decl) {
+    beginNode(p_decl, NodeKind::kDecl);
+    const auto &variables = p_decl.getVariables();
+    writeVarint(variables.size());
+    for (const auto &variable : variables) {
+        m_declaring_node_ids.emplace(&variable->getName(), m_node_offsets.size());
+        numberNode(*variable);
+        writeVarint(variable->getLocation().line);
+        writeVarint(variable->getLocation().col);
+        writeString(variable->getName());
+    }
+
+    // The variables share the type and the constant, if any.
+    const ConstantValueNode *constant_node =
+        variables.empty() ? nullptr : variables.front()->getConstantValueNodePtr();
+    writeVarint(constant_node != nullptr);
+    if (constant_node) {
+        numberNode(*constant_node);
+        writeVarint(constant_node->getLocation().line);
+        writeVarint(constant_node->getLocation().col);
+        writeConstant(*constant_node->getConstantPtr());
+        writeType(constant_node->getInferredType());
+    } else {
+        writeType(variables.empty() ? nullptr : variables.front()->getTypePtr());
+    }
+}
+
+void ModuleWriter::visit(ConstantValueNode &p_constant_value) {
+    beginNode(p_constant_value, NodeKind::kConstantValue);
+    writeConstant(*p_constant_value.getConstantPtr());
+    writeType(p_constant_value.getInferredType());
+}
+
+void ModuleWriter::visit(FunctionNode &p_function) {
+    beginNode(p_function, NodeKind::kFunction);
+    m_declaring_node_ids.emplace(&p_function.getName(), m_node_ids[&p_function]);
+    writeString(p_function.getName());
+    writeType(p_function.getTypePtr());
+    writeVarint(p_function.getParameters().size());
+    writeVarint(p_function.getBody() != nullptr);
+    p_function.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(CompoundStatementNode &p_compound_statement) {
+    beginNode(p_compound_statement, NodeKind::kCompoundStatement);
+    writeVarint(p_compound_statement.getDeclarations().size());
+    writeVarint(p_compound_statement.getStatements().size());
+    p_compound_statement.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(PrintNode &p_print) {
+    beginNode(p_print, NodeKind::kPrint);
+    p_print.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(BinaryOperatorNode &p_bin_op) {
+    beginNode(p_bin_op, NodeKind::kBinaryOperator);
+    writeVarint(static_cast<uint64_t>(p_bin_op.getOp()));
+    writeType(p_bin_op.getInferredType());
+    p_bin_op.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(UnaryOperatorNode &p_un_op) {
+    beginNode(p_un_op, NodeKind::kUnaryOperator);
+    writeVarint(static_cast<uint64_t>(p_un_op.getOp()));
+    writeType(p_un_op.getInferredType());
+    p_un_op.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(FunctionInvocationNode &p_func_invocation) {
+    beginNode(p_func_invocation, NodeKind::kFunctionInvocation);
+    writeString(p_func_invocation.getName());
+    writeVarint(p_func_invocation.getArguments().size());
+    writeType(p_func_invocation.getInferredType());
+    p_func_invocation.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(VariableReferenceNode &p_variable_ref) {
+    beginNode(p_variable_ref, NodeKind::kVariableReference);
+    writeString(p_variable_ref.getName());
+    writeVarint(p_variable_ref.getIndices().size());
+    writeType(p_variable_ref.getInferredType());
+    p_variable_ref.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(AssignmentNode &p_assignment) {
+    beginNode(p_assignment, NodeKind::kAssignment);
+    p_assignment.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(ReadNode &p_read) {
+    beginNode(p_read, NodeKind::kRead);
+    p_read.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(IfNode &p_if) {
+    beginNode(p_if, NodeKind::kIf);
+    writeVarint(p_if.getElseBody() != nullptr);
+    p_if.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(WhileNode &p_while) {
+    beginNode(p_while, NodeKind::kWhile);
+    p_while.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(ForNode &p_for) {
+    beginNode(p_for, NodeKind::kFor);
+    p_for.visitChildNodes(*this);
+}
+
+void ModuleWriter::visit(ReturnNode &p_return) {
+    beginNode(p_return, NodeKind::kReturn);
+    p_return.visitChildNodes(*this);
+}
+
+bool ModuleWriter::writeSymbolTables(
+    const CheckedModule::SymbolTables &p_symbol_tables) {
+    writeVarint(p_symbol_tables.size());
+    for (const auto &scoping_node_and_table : p_symbol_tables) {
+        auto scoping_node = m_node_ids.find(scoping_node_and_table.first);
+        if (scoping_node == m_node_ids.end()) {
+            return false;
+        }
+        writeVarint(scoping_node->second);
+
+        // A scope without symbols has no table.
+        const auto &table = scoping_node_and_table.second;
+        writeVarint(table ? table->getEntries().size() : 0);
+        if (!table) {
+            continue;
+        }
+        for (const auto &entry : table->getEntries()) {
+            auto declaring_node = m_declaring_node_ids.find(&entry.getName());
+            if (declaring_node == m_declaring_node_ids.end()) {
+                return false;
+            }
+            writeVarint(declaring_node->second);
+            writeVarint(static_cast<uint64_t>(entry.getKind()));
+            writeVarint(entry.getLevel());
+        }
+    }
+    return true;
+}
+
+void ModuleWriter::writeIndex() {
+    const auto index_offset = static_cast<uint32_t>(m_bytes.size());
+    for (const auto offset : m_node_offsets) {
+        writeFixed32(offset);
+    }
+    writeFixed32(index_offset);
+    writeFixed32(static_cast<uint32_t>(m_node_offsets.size()));
+    writeMagic(kIndexMagic);
+}
+
+/// @brief Rebuilds the nodes from the mapped bytes. A malformed file is
+/// decoded to the end with dummy values and only reported afterwards, so
+/// that every node constructed so far is still owned by its parent.
+class ModuleReader {
+  private:
+    const uint8_t *m_cursor;
+    const uint8_t *m_end;
+    bool m_is_malformed = false;
+    std::vector<AstNode *> m_nodes;
+
+  public:
+    ~ModuleReader() = default;
+    ModuleReader(const uint8_t *p_begin, const uint8_t *p_end)
+        : m_cursor(p_begin), m_end(p_end) {}
+
+    bool isMalformed() const { return m_is_malformed; }
+    /// @return `nullptr` if the id does not refer to a node.
+    AstNode *getNode(uint64_t p_id) const {
+        return p_id < m_nodes.size() ? m_nodes[p_id] : nullptr;
+    }
+
+    uint64_t readVarint();
+    int64_t readSigned() {
+        const uint64_t value = readVarint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+    uint8_t readByte();
+    std::string readString();
+    bool readMagic(const char *p_magic);
+
+    /// @return `nullptr` on a malformed node; so are its children.
+    AstNode *readNode();
+    /// @return `nullptr` if the node is not a `NodeT`.
+    template <typename NodeT> NodeT *readNodeOf();
+
+  private:
+    size_t reserveId() {
+        m_nodes.push_back(nullptr);
+        return m_nodes.size() - 1;
+    }
+    PType *readType();
+    Operator readOperator() {
+        const uint64_t op = readVarint();
+        if (op > static_cast<uint64_t>(Operator::kOrOp)) {
+            m_is_malformed = true;
+        }
+        return static_cast<Operator>(op);
+    }
+    Constant *readConstant();
+    DeclNode *readDecl(size_t p_id, uint32_t p_line, uint32_t p_col);
+    template <typename NodeT>
+    std::vector<std::unique_ptr<NodeT>> readNodes(uint64_t p_count);
+};
+
+uint64_t ModuleReader::readVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (m_cursor == m_end) {
+            break;
+        }
+        const uint8_t byte = *m_cursor++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    m_is_malformed = true;
+    return 0;
+}
+
+uint8_t ModuleReader::readByte() {
+    if (m_cursor == m_end) {
+        m_is_malformed = true;
+        return 0;
+    }
+    return *m_cursor++;
+}
+
+std::string ModuleReader::readString() {
+    const uint64_t size = readVarint();
+    if (size > static_cast<uint64_t>(m_end - m_cursor)) {
+        m_is_malformed = true;
+        return "";
+    }
+    std::string string(reinterpret_cast<const char *>(m_cursor), size);
+    m_cursor += size;
+    return string;
+}
+
+bool ModuleReader::readMagic(const char *p_magic) {
+    for (size_t i = 0; i < 4; ++i) {
+        if (readByte() != static_cast<uint8_t>(p_magic[i])) {
+            m_is_malformed = true;
+        }
+    }
+    return !m_is_malformed;
+}
+
+PType *ModuleReader::readType() {
+    const uint8_t primitive = readByte();
+    if (primitive == kNoType) {
+        return nullptr;
+    }
+    if (primitive > static_cast<uint8_t>(PType::PrimitiveTypeEnum::kErrorType)) {
+        m_is_malformed = true;
+    }
+    auto *type = new PType(static_cast<PType::PrimitiveTypeEnum>(primitive));
+    std::vector<uint64_t> dims(std::min<uint64_t>(readVarint(), m_end - m_cursor));
+    for (auto &dim : dims) {
+        dim = readVarint();
+    }
+    type->setDimensions(dims);
+    return type;
+}
+
+Constant *ModuleReader::readConstant() {
+    PType *type = readType();
+    if (!type) {
+        m_is_malformed = true;
+        type = new PType(PType::PrimitiveTypeEnum::kIntegerType);
+    }
+
+    Constant::ConstantValue value;
+    value.integer = 0;
+    switch (type->getPrimitiveType()) {
+    case PType::PrimitiveTypeEnum::kIntegerType:
+        value.integer = readSigned();
+        break;
+    case PType::PrimitiveTypeEnum::kRealType: {
+        const uint64_t bits = readVarint();
+        memcpy(&value.real, &bits, sizeof(bits));
+        break;
+    }
+    case PType::PrimitiveTypeEnum::kBoolType:
+        value.boolean = readVarint() != 0;
+        break;
+    case PType::PrimitiveTypeEnum::kStringType:
+        value.string = strdup(readString().c_str());
+        break;
+    default:
+        break;
+    }
+    return new Constant(PTypeSharedPtr{type}, value);
+}
+
+template <typename NodeT>
+std::vector<std::unique_ptr<NodeT>> ModuleReader::readNodes(uint64_t p_count) {
+    std::vector<std::unique_ptr<NodeT>> nodes;
+    for (uint64_t i = 0; i < p_count && !m_is_malformed; ++i) {
+        nodes.emplace_back(readNodeOf<NodeT>());
+    }
+    return nodes;
+}
+
+template <typename NodeT> NodeT *ModuleReader::readNodeOf() {
+    AstNode *node = readNode();
+    auto *typed_node = dynamic_cast<NodeT *>(node);
+    if (!typed_node) {
+        m_is_malformed = true;
+        delete node;
+    }
+    return typed_node;
+}
+
+DeclNode *ModuleReader::readDecl(size_t p_id, uint32_t p_line, uint32_t p_col) {
+    std::vector<IdInfo> ids;
+    std::vector<size_t> variable_ids;
+    const uint64_t num_variables = readVarint();
+    for (uint64_t i = 0; i < num_variables && !m_is_malformed; ++i) {
+        variable_ids.push_back(reserveId());
+        const auto line = static_cast<uint32_t>(readVarint());
+        const auto col = static_cast<uint32_t>(readVarint());
+        ids.emplace_back(line, col, readString().c_str());
+    }
+
+    DeclNode *decl = nullptr;
+    if (readVarint()) {
+        const size_t constant_id = reserveId();
+        const auto line = static_cast<uint32_t>(readVarint());
+        const auto col = static_cast<uint32_t>(readVarint());
+        auto *constant_node = new ConstantValueNode(line, col, readConstant());
+        constant_node->setInferredType(readType());
+        m_nodes[constant_id] = constant_node;
+        decl = new DeclNode(p_line, p_col, &ids, constant_node);
+    } else {
+        decl = new DeclNode(p_line, p_col, &ids, readType());
+    }
+
+    m_nodes[p_id] = decl;
+    for (size_t i = 0; i < variable_ids.size(); ++i) {
+        m_nodes[variable_ids[i]] = decl->getVariables()[i].get();
+    }
+    return decl;
+}
+
+AstNode *ModuleReader::readNode() {
+    if (m_is_malformed) {
+        return nullptr;
+    }
+    const size_t id = reserveId();
+    const auto kind = static_cast<NodeKind>(readByte());
+    const auto line = static_cast<uint32_t>(readVarint());
+    const auto col = static_cast<uint32_t>(readVarint());
+
+    AstNode *node = nullptr;
+    switch (kind) {
+    case NodeKind::kProgram: {
+        const std::string name = readString();
+        PType *type = readType();
+        const uint64_t num_decls = readVarint();
+        const uint64_t num_funcs = readVarint();
+        auto decls = readNodes<DeclNode>(num_decls);
+        auto funcs = readNodes<FunctionNode>(num_funcs);
+        node = new ProgramNode(line, col, name.c_str(), type, decls, funcs,
+                               readNodeOf<CompoundStatementNode>());
+        break;
+    }
+    case NodeKind::kDecl:
+        return readDecl(id, line, col);
+    case NodeKind::kConstantValue: {
+        auto *constant = new ConstantValueNode(line, col, readConstant());
+        constant->setInferredType(readType());
+        node = constant;
+        break;
+    }
+    case NodeKind::kFunction: {
+        const std::string name = readString();
+        PType *type = readType();
+        const uint64_t num_parameters = readVarint();
+        const bool has_body = readVarint() != 0;
+        auto parameters = readNodes<DeclNode>(num_parameters);
+        node = new FunctionNode(
+            line, col, name.c_str(), parameters, type,
+            has_body ? readNodeOf<CompoundStatementNode>() : nullptr);
+        break;
+    }
+    case NodeKind::kCompoundStatement: {
+        const uint64_t num_decls = readVarint();
+        const uint64_t num_stmts = readVarint();
+        auto decls = readNodes<DeclNode>(num_decls);
+        auto stmts = readNodes<AstNode>(num_stmts);
+        node = new CompoundStatementNode(line, col, decls, stmts);
+        break;
+    }
+    case NodeKind::kPrint:
+        node = new PrintNode(line, col, readNodeOf<ExpressionNode>());
+        break;
+    case NodeKind::kBinaryOperator: {
+        const auto op = readOperator();
+        PType *type = readType();
+        auto *left = readNodeOf<ExpressionNode>();
+        auto *bin_op = new BinaryOperatorNode(line, col, op, left,
+                                              readNodeOf<ExpressionNode>());
+        bin_op->setInferredType(type);
+        node = bin_op;
+        break;
+    }
+    case NodeKind::kUnaryOperator: {
+        const auto op = readOperator();
+        PType *type = readType();
+        auto *un_op =
+            new UnaryOperatorNode(line, col, op, readNodeOf<ExpressionNode>());
+        un_op->setInferredType(type);
+        node = un_op;
+        break;
+    }
+    case NodeKind::kFunctionInvocation: {
+        const std::string name = readString();
+        const uint64_t num_args = readVarint();
+        PType *type = readType();
+        auto args = readNodes<ExpressionNode>(num_args);
+        auto *invocation =
+            new FunctionInvocationNode(line, col, name.c_str(), args);
+        invocation->setInferredType(type);
+        node = invocation;
+        break;
+    }
+    case NodeKind::kVariableReference: {
+        const std::string name = readString();
+        const uint64_t num_indices = readVarint();
+        PType *type = readType();
+        auto indices = readNodes<ExpressionNode>(num_indices);
+        auto *ref = new VariableReferenceNode(line, col, name.c_str(), indices);
+        ref->setInferredType(type);
+        node = ref;
+        break;
+    }
+    case NodeKind::kAssignment: {
+        auto *lvalue = readNodeOf<VariableReferenceNode>();
+        node = new AssignmentNode(line, col, lvalue,
+                                  readNodeOf<ExpressionNode>());
+        break;
+    }
+    case NodeKind::kRead:
+        node = new ReadNode(line, col, readNodeOf<VariableReferenceNode>());
+        break;
+    case NodeKind::kIf: {
+        const bool has_else = readVarint() != 0;
+        auto *condition = readNodeOf<ExpressionNode>();
+        auto *body = readNodeOf<CompoundStatementNode>();
+        node = new IfNode(line, col, condition, body,
+                          has_else ? readNodeOf<CompoundStatementNode>()
+                                   : nullptr);
+        break;
+    }
+    case NodeKind::kWhile: {
+        auto *condition = readNodeOf<ExpressionNode>();
+        node = new WhileNode(line, col, condition,
+                             readNodeOf<CompoundStatementNode>());
+        break;
+    }
+    case NodeKind::kFor: {
+        // The bounds are literals, as the syntax ensures.
+        auto *decl = readNodeOf<DeclNode>();
+        auto *init = readNodeOf<AssignmentNode>();
+        if (init && !dynamic_cast<const ConstantValueNode *>(&init->getExpr())) {
+            m_is_malformed = true;
+        }
+        auto *end_condition = readNodeOf<ConstantValueNode>();
+        node = new ForNode(line, col, decl, init, end_condition,
+                           readNodeOf<CompoundStatementNode>());
+        break;
+    }
+    case NodeKind::kReturn:
+        node = new ReturnNode(line, col, readNodeOf<ExpressionNode>());
+        break;
+    default:
+        m_is_malformed = true;
+        return nullptr;
+    }
+    m_nodes[id] = node;
+    return node;
+}
+
+/// @brief Checks that a decoded module holds together the way the back end
+/// relies on, since the bytes of a corrupted file may decode to a tree that
+/// no source checks into: every scoping node has its table, every symbol is
+/// at the level of its scope, every name resolves to a symbol of the right
+/// kind, and every expression has its type.
+///
+/// Walks the scopes like `NameResolver`, but stops at the first violation
+/// instead of trusting the tables.
+class ModuleValidator final : public AstNodeVisitor {
+  public:
+    using SymbolTables = CheckedModule::SymbolTables;
+
+  private:
+    SymbolManager m_symbol_manager;
+    const SymbolTables &m_symbol_tables;
+    bool m_is_valid = true;
+
+    bool enterScope(const AstNode &p_node);
+    void leaveScope() { m_symbol_manager.popScope(); }
+    void checkType(const PType *p_type) {
+        m_is_valid = m_is_valid && p_type;
+    }
+
+  public:
+    ~ModuleValidator() = default;
+    explicit ModuleValidator(const SymbolTables &p_symbol_tables)
+        : m_symbol_manager(false /* no dump */),
+          m_symbol_tables(p_symbol_tables) {}
+
+    bool isValid() const { return m_is_valid; }
+
+    void visit(ProgramNode &p_program) override;
+    void visit(DeclNode &p_decl) override { p_decl.visitChildNodes(*this); }
+    void visit(VariableNode &p_variable) override;
+    void visit(ConstantValueNode &p_constant_value) override {
+        checkType(p_constant_value.getInferredType());
+    }
+    void visit(FunctionNode &p_function) override;
+    void visit(CompoundStatementNode &p_compound_statement) override;
+    void visit(PrintNode &p_print) override { p_print.visitChildNodes(*this); }
+    void visit(BinaryOperatorNode &p_bin_op) override;
+    void visit(UnaryOperatorNode &p_un_op) override;
+    void visit(FunctionInvocationNode &p_func_invocation) override;
+    void visit(VariableReferenceNode &p_variable_ref) override;
+    void visit(AssignmentNode &p_assignment) override {
+        p_assignment.visitChildNodes(*this);
+    }
+    void visit(ReadNode &p_read) override { p_read.visitChildNodes(*this); }
+    void visit(IfNode &p_if) override { p_if.visitChildNodes(*this); }
+    void visit(WhileNode &p_while) override { p_while.visitChildNodes(*this); }
+    void visit(ForNode &p_for) override;
+    void visit(ReturnNode &p_return) override { p_return.visitChildNodes(*this); }
+};
+
+bool ModuleValidator::enterScope(const AstNode &p_node) {
+    auto table = m_symbol_tables.find(&p_node);
+    if (!m_is_valid || table == m_symbol_tables.end()) {
+        m_is_valid = false;
+        return false;
+    }
+    m_symbol_manager.pushScope(table->second);
+    if (table->second) {
+        for (const auto &entry : table->second->getEntries()) {
+            if (entry.getLevel() != m_symbol_manager.getCurrentLevel()) {
+                m_is_valid = false;
+            }
+        }
+    }
+    return true;
+}
+
+void ModuleValidator::visit(ProgramNode &p_program) {
+    if (enterScope(p_program)) {
+        p_program.visitChildNodes(*this);
+        leaveScope();
+    }
+}
+
+void ModuleValidator::visit(VariableNode &p_variable) {
+    checkType(p_variable.getTypePtr());
+    p_variable.visitChildNodes(*this);
+}
+
+void ModuleValidator::visit(FunctionNode &p_function) {
+    // The parameters and the body share the scope of the function.
+    if (enterScope(p_function)) {
+        p_function.visitParamChildNodes(*this);
+        p_function.visitBodyChildNodes(*this);
+        leaveScope();
+    }
+}
+
+void ModuleValidator::visit(CompoundStatementNode &p_compound_statement) {
+    if (enterScope(p_compound_statement)) {
+        p_compound_statement.visitChildNodes(*this);
+        leaveScope();
+    }
+}
+
+void ModuleValidator::visit(BinaryOperatorNode &p_bin_op) {
+    checkType(p_bin_op.getInferredType());
+    p_bin_op.visitChildNodes(*this);
+}
+
+void ModuleValidator::visit(UnaryOperatorNode &p_un_op) {
+    checkType(p_un_op.getInferredType());
+    p_un_op.visitChildNodes(*this);
+}
+
+void ModuleValidator::visit(FunctionInvocationNode &p_func_invocation) {
+    checkType(p_func_invocation.getInferredType());
+    const SymbolEntry *entry =
+        m_symbol_manager.lookup(p_func_invocation.getName());
+    if (!entry || entry->getKind() != SymbolEntry::KindEnum::kFunctionKind ||
+        FunctionNode::getParametersNum(*entry->getAttribute().parameters()) !=
+            p_func_invocation.getArguments().size()) {
+        m_is_valid = false;
+        return;
+    }
+    p_func_invocation.visitChildNodes(*this);
+}
+
+void ModuleValidator::visit(VariableReferenceNode &p_variable_ref) {
+    checkType(p_variable_ref.getInferredType());
+    const SymbolEntry *entry = m_symbol_manager.lookup(p_variable_ref.getName());
+    if (!entry || entry->getKind() == SymbolEntry::KindEnum::kProgramKind ||
+        entry->getKind() == SymbolEntry::KindEnum::kFunctionKind ||
+        p_variable_ref.getIndices().size() >
+            entry->getTypePtr()->getDimensions().size()) {
+        m_is_valid = false;
+        return;
+    }
+    p_variable_ref.visitChildNodes(*this);
+}
+
+void ModuleValidator::visit(ForNode &p_for) {
+    if (enterScope(p_for)) {
+        p_for.visitChildNodes(*this);
+        leaveScope();
+    }
+}
+} // namespace
+
+bool CheckedModule::write(const std::string &p_path,
+                          const std::string &p_source_path,
+                          const ProgramNode &p_program,
+                          const std::vector<const InterfaceFile *> &p_imports,
+                          const SymbolTables &p_symbol_tables) {
+    ModuleWriter writer;
+    writer.writeMagic(kMagic);
+    writer.writeVarint(kVersion);
+    writer.writeString(p_source_path);
+    const_cast<ProgramNode &>(p_program).accept(writer);
+
+    size_t num_decl_nodes = 0;
+    size_t num_func_nodes = 0;
+    for (const auto *interface : p_imports) {
+        num_decl_nodes += interface->getDeclNodes().size();
+        num_func_nodes += interface->getFuncNodes().size();
+    }
+    writer.writeVarint(num_decl_nodes);
+    for (const auto *interface : p_imports) {
+        for (const auto &decl_node : interface->getDeclNodes()) {
+            decl_node->accept(writer);
+        }
+    }
+    writer.writeVarint(num_func_nodes);
+    for (const auto *interface : p_imports) {
+        for (const auto &func_node : interface->getFuncNodes()) {
+            func_node->accept(writer);
+        }
+    }
+
+    if (!writer.writeSymbolTables(p_symbol_tables)) {
+        fprintf(stderr, "A symbol is declared outside of the module\n");
+        return false;
+    }
+    writer.writeIndex();
+
+    FILE *out = fopen(p_path.c_str(), "wb");
+    if (!out) {
+        perror("Failed to open the module");
+        return false;
+    }
+    const auto &bytes = writer.getBytes();
+    const bool is_written = fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+    return fclose(out) == 0 && is_written;
+}
+
+bool CheckedModule::isPrelude() const {
+    for (const auto &func_node : m_program->getFuncNodes()) {
+        if (func_node->getBody()) {
+            return false;
+        }
+    }
+    return m_program->getBody().getDeclarations().empty() &&
+           m_program->getBody().getStatements().empty() &&
+           m_imported_decl_nodes.empty() && m_imported_func_nodes.empty();
+}
+
+std::unique_ptr<CheckedModule> CheckedModule::read(const std::string &p_path) {
+    const int fd = open(p_path.c_str(), O_RDONLY);
+    struct stat status;
+    if (fd < 0 || fstat(fd, &status) < 0) {
+        perror("Failed to open the module");
+        if (fd >= 0) {
+            close(fd);
+        }
+        return nullptr;
+    }
+    const size_t size = status.st_size;
+    void *mapping = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)
+                         : MAP_FAILED;
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Failed to map the module %s\n", p_path.c_str());
+        return nullptr;
+    }
+
+    const auto *bytes = static_cast<const uint8_t *>(mapping);
+    ModuleReader reader(bytes, bytes + size);
+    std::unique_ptr<CheckedModule> module(new CheckedModule);
+    if (reader.readMagic(kMagic) && reader.readVarint() == kVersion) {
+        module->m_source_path = reader.readString();
+        module->m_program.reset(reader.readNodeOf<ProgramNode>());
+        const uint64_t num_decl_nodes = reader.readVarint();
+        for (uint64_t i = 0; i < num_decl_nodes && !reader.isMalformed(); ++i) {
+            module->m_imported_decl_nodes.emplace_back(reader.readNodeOf<DeclNode>());
+        }
+        const uint64_t num_func_nodes = reader.readVarint();
+        for (uint64_t i = 0; i < num_func_nodes && !reader.isMalformed(); ++i) {
+            module->m_imported_func_nodes.emplace_back(reader.readNodeOf<FunctionNode>());
+        }
+    }
+
+    // The entries refer to the name, type and attribute of their declaring
+    // node, like the ones `SemanticAnalyzer` adds.
+    const uint64_t num_tables = reader.isMalformed() ? 0 : reader.readVarint();
+    for (uint64_t i = 0; i < num_tables && !reader.isMalformed(); ++i) {
+        const AstNode *scoping_node = reader.getNode(reader.readVarint());
+        auto table = std::make_shared<SymbolTable>();
+
+        const uint64_t num_entries = reader.readVarint();
+        for (uint64_t j = 0; j < num_entries && !reader.isMalformed(); ++j) {
+            const AstNode *node = reader.getNode(reader.readVarint());
+            const auto kind = static_cast<SymbolEntry::KindEnum>(reader.readVarint());
+            const size_t level = reader.readVarint();
+            if (kind > SymbolEntry::KindEnum::kConstantKind) {
+                break;
+            }
+            // The kind has to agree with the declaring node.
+            const auto *program = dynamic_cast<const ProgramNode *>(node);
+            const auto *function = dynamic_cast<const FunctionNode *>(node);
+            const auto *variable = dynamic_cast<const VariableNode *>(node);
+            if (program && kind == SymbolEntry::KindEnum::kProgramKind) {
+                table->addSymbol(program->getName(), kind, level,
+                                 program->getTypePtr(),
+                                 static_cast<const Constant *>(nullptr));
+            } else if (function && kind == SymbolEntry::KindEnum::kFunctionKind) {
+                table->addSymbol(function->getName(), kind, level,
+                                 function->getTypePtr(),
+                                 &function->getParameters());
+            } else if (variable && kind >= SymbolEntry::KindEnum::kParameterKind &&
+                       (kind != SymbolEntry::KindEnum::kConstantKind ||
+                        variable->getConstantPtr())) {
+                table->addSymbol(variable->getName(), kind, level,
+                                 variable->getTypePtr(),
+                                 variable->getConstantPtr());
+            } else {
+                break;
+            }
+        }
+        if (!scoping_node || table->getEntries().size() != num_entries) {
+            break;
+        }
+        module->m_symbol_table_of_scoping_nodes[scoping_node] = std::move(table);
+    }
+    bool is_complete = !reader.isMalformed() && module->m_program &&
+                       module->m_symbol_table_of_scoping_nodes.size() == num_tables;
+    munmap(mapping, size);
+
+    if (is_complete) {
+        ModuleValidator validator(module->m_symbol_table_of_scoping_nodes);
+        module->m_program->accept(validator);
+        is_complete = validator.isValid();
+    }
+    if (!is_complete) {
+        fprintf(stderr, "Malformed module %s\n", p_path.c_str());
+        return nullptr;
+    }
+    return module;
+}
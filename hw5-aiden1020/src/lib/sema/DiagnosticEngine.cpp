@@ -0,0 +1,76 @@
+#include "sema/DiagnosticEngine.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "AST/ast.hpp"
+
+DiagnosticEngine::DiagnosticEngine(const ErrorPrinter &p_printer,
+                                   uint32_t p_error_limit)
+    : m_printer{p_printer}, m_error_limit{p_error_limit} {}
+
+bool DiagnosticEngine::admit(const char *p_id, Location p_location,
+                             const std::string &p_symbol_name) {
+  std::string key;
+  if (!p_symbol_name.empty()) {
+    key = std::string(p_id) + '\0' + p_symbol_name;
+    const auto it = m_index_of_symbol_error.find(key);
+    if (it != m_index_of_symbol_error.end()) {
+      m_diagnostics[it->second].m_repeats.push_back(p_location);
+      return false;
+    }
+  }
+  if (m_error_limit != 0 && m_diagnostics.size() >= m_error_limit) {
+    ++m_num_dropped;
+    return false;
+  }
+  if (!key.empty()) {
+    m_index_of_symbol_error.emplace(std::move(key), m_diagnostics.size());
+  }
+  return true;
+}
+
+void DiagnosticEngine::report(const Error &p_error) {
+  // The message is only built for the errors that are kept.
+  if (admit(p_error.getId(), p_error.getLocation(),
+            p_error.getSymbolName())) {
+    m_diagnostics.push_back(
+        {p_error.getId(), p_error.getLocation(), p_error.getMessage(), {}});
+  }
+}
+
+void DiagnosticEngine::report(const char *p_id, Location p_location,
+                              std::string p_message,
+                              const std::string &p_symbol_name) {
+  if (admit(p_id, p_location, p_symbol_name)) {
+    m_diagnostics.push_back({p_id, p_location, std::move(p_message), {}});
+  }
+}
+
+void DiagnosticEngine::flush() {
+  // Stable, so that errors at the same location keep the order they are
+  // found in.
+  std::stable_sort(m_diagnostics.begin(), m_diagnostics.end(),
+                   [](const Diagnostic &p_lhs, const Diagnostic &p_rhs) {
+                     return p_lhs.m_location.line != p_rhs.m_location.line
+                                ? p_lhs.m_location.line < p_rhs.m_location.line
+                                : p_lhs.m_location.col < p_rhs.m_location.col;
+                   });
+  for (const auto &diagnostic : m_diagnostics) {
+    m_printer.print(diagnostic.m_id, diagnostic.m_location,
+                    diagnostic.m_message, diagnostic.m_repeats);
+  }
+  if (m_num_dropped > 0) {
+    m_printer.printNote("error-limit",
+                        "Too many errors; " + std::to_string(m_num_dropped) +
+                        " more are not shown (-ferror-limit=" +
+                        std::to_string(m_error_limit) + ").",
+                        m_num_dropped);
+  }
+  m_printer.finish();
+  m_diagnostics.clear();
+  m_index_of_symbol_error.clear();
+  m_num_dropped = 0;
+}
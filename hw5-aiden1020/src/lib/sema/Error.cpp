@@ -11,6 +11,8 @@ Error::Error(Location p_location) : m_location{p_location} {}
 
 Location Error::getLocation() const { return m_location; }
 
+std::string Error::getSymbolName() const { return ""; }
+
 SymbolRedeclarationError::SymbolRedeclarationError(Location p_location,
                                                    std::string p_symbol_name)
     : Error{p_location}, m_symbol_name{std::move(p_symbol_name)} {}
@@ -19,6 +21,10 @@ std::string SymbolRedeclarationError::getMessage() const {
   return "symbol '" + m_symbol_name + "' is redeclared";
 }
 
+const char *SymbolRedeclarationError::getId() const {
+  return "symbol-redeclaration";
+}
+
 NonPositiveArrayDimensionError::NonPositiveArrayDimensionError(
     Location p_location, std::string p_symbol_name)
     : Error{p_location}, m_symbol_name{std::move(p_symbol_name)} {}
@@ -28,6 +34,10 @@ std::string NonPositiveArrayDimensionError::getMessage() const {
          "' declared as an array with an index that is not greater than 0";
 }
 
+const char *NonPositiveArrayDimensionError::getId() const {
+  return "non-positive-array-dimension";
+}
+
 UndeclaredSymbolError::UndeclaredSymbolError(Location p_location,
                                              std::string p_symbol_name)
     : Error{p_location}, m_symbol_name{std::move(p_symbol_name)} {}
@@ -36,6 +46,12 @@ std::string UndeclaredSymbolError::getMessage() const {
   return "use of undeclared symbol '" + m_symbol_name + "'";
 }
 
+const char *UndeclaredSymbolError::getId() const { return "undeclared-symbol"; }
+
+std::string UndeclaredSymbolError::getSymbolName() const {
+  return m_symbol_name;
+}
+
 NonVariableSymbolError::NonVariableSymbolError(Location p_location,
                                                std::string p_symbol_name)
     : Error{p_location}, m_symbol_name{std::move(p_symbol_name)} {}
@@ -44,6 +60,14 @@ std::string NonVariableSymbolError::getMessage() const {
   return "use of non-variable symbol '" + m_symbol_name + "'";
 }
 
+const char *NonVariableSymbolError::getId() const {
+  return "non-variable-symbol";
+}
+
+std::string NonVariableSymbolError::getSymbolName() const {
+  return m_symbol_name;
+}
+
 NonFunctionSymbolError::NonFunctionSymbolError(Location p_location,
                                                std::string p_symbol_name)
     : Error{p_location}, m_symbol_name{std::move(p_symbol_name)} {}
@@ -52,10 +76,22 @@ std::string NonFunctionSymbolError::getMessage() const {
   return "call of non-function symbol '" + m_symbol_name + "'";
 }
 
+const char *NonFunctionSymbolError::getId() const {
+  return "non-function-symbol";
+}
+
+std::string NonFunctionSymbolError::getSymbolName() const {
+  return m_symbol_name;
+}
+
 std::string NonIntegerArrayIndexError::getMessage() const {
   return "index of array reference must be an integer";
 }
 
+const char *NonIntegerArrayIndexError::getId() const {
+  return "non-integer-array-index";
+}
+
 OverArraySubscriptError::OverArraySubscriptError(Location p_location,
                                                  std::string p_symbol_name)
     : Error{p_location}, m_symbol_name{std::move(p_symbol_name)} {}
@@ -64,6 +100,10 @@ std::string OverArraySubscriptError::getMessage() const {
   return "there is an over array subscript on '" + m_symbol_name + "'";
 }
 
+const char *OverArraySubscriptError::getId() const {
+  return "over-array-subscript";
+}
+
 InvalidBinaryOperandError::InvalidBinaryOperandError(Location p_location,
                                                      Operator p_op,
                                                      const PType *p_lhs,
@@ -76,6 +116,10 @@ std::string InvalidBinaryOperandError::getMessage() const {
          m_lhs->getPTypeCString() + "' and '" + m_rhs->getPTypeCString() + "')";
 }
 
+const char *InvalidBinaryOperandError::getId() const {
+  return "invalid-binary-operand";
+}
+
 InvalidUnaryOperandError::InvalidUnaryOperandError(Location p_location,
                                                    Operator p_op,
                                                    const PType *p_operand)
@@ -87,6 +131,10 @@ std::string InvalidUnaryOperandError::getMessage() const {
          m_operand->getPTypeCString() + "')";
 }
 
+const char *InvalidUnaryOperandError::getId() const {
+  return "invalid-unary-operand";
+}
+
 ArgumentNumberMismatchError::ArgumentNumberMismatchError(
     Location p_location, std::string p_function_name)
     : Error{p_location}, m_function_name{std::move(p_function_name)} {}
@@ -96,6 +144,10 @@ std::string ArgumentNumberMismatchError::getMessage() const {
          "'";
 }
 
+const char *ArgumentNumberMismatchError::getId() const {
+  return "argument-number-mismatch";
+}
+
 IncompatibleArgumentTypeError::IncompatibleArgumentTypeError(
     Location p_location, const PType *p_expected, const PType *p_actual)
     : Error{p_location},
@@ -108,23 +160,43 @@ std::string IncompatibleArgumentTypeError::getMessage() const {
          std::string{m_expected->getPTypeCString()} + "'";
 }
 
+const char *IncompatibleArgumentTypeError::getId() const {
+  return "incompatible-argument-type";
+}
+
 std::string ReadToNonScalarTypeError::getMessage() const {
   return "variable reference of read statement must be scalar type";
 }
 
+const char *ReadToNonScalarTypeError::getId() const {
+  return "read-to-non-scalar-type";
+}
+
 std::string ReadToConstantOrLoopVarError::getMessage() const {
   return "variable reference of read statement cannot be a constant or loop "
          "variable";
 }
 
+const char *ReadToConstantOrLoopVarError::getId() const {
+  return "read-to-constant-or-loop-var";
+}
+
 std::string PrintOutNonScalarTypeError ::getMessage() const {
   return "expression of print statement must be scalar type";
 }
 
+const char *PrintOutNonScalarTypeError::getId() const {
+  return "print-out-non-scalar-type";
+}
+
 std::string AssignWithArrayTypeError::getMessage() const {
   return "array assignment is not allowed";
 }
 
+const char *AssignWithArrayTypeError::getId() const {
+  return "assign-with-array-type";
+}
+
 AssignToConstantError::AssignToConstantError(Location p_location,
                                              std::string p_symbol_name)
     : Error{p_location}, m_symbol_name{std::move(p_symbol_name)} {}
@@ -134,10 +206,16 @@ std::string AssignToConstantError::getMessage() const {
          "' which is a constant";
 }
 
+const char *AssignToConstantError::getId() const {
+  return "assign-to-constant";
+}
+
 std::string AssignToLoopVarError::getMessage() const {
   return "the value of loop variable cannot be modified inside the loop body";
 }
 
+const char *AssignToLoopVarError::getId() const { return "assign-to-loop-var"; }
+
 IncompatibleAssignmentError::IncompatibleAssignmentError(Location p_location,
                                                          const PType *p_lval,
                                                          const PType *p_rval)
@@ -149,19 +227,33 @@ std::string IncompatibleAssignmentError::getMessage() const {
          "'";
 }
 
+const char *IncompatibleAssignmentError::getId() const {
+  return "incompatible-assignment";
+}
+
 std::string NonBooleanConditionError::getMessage() const {
   return "the expression of condition must be boolean type";
 }
 
+const char *NonBooleanConditionError::getId() const {
+  return "non-boolean-condition";
+}
+
 std::string NonIncrementalLoopVariableError::getMessage() const {
   return "the lower bound and upper bound of iteration count must be in the "
          "incremental order";
 }
 
+const char *NonIncrementalLoopVariableError::getId() const {
+  return "non-incremental-loop-variable";
+}
+
 std::string ReturnFromVoidError::getMessage() const {
   return "program/procedure should not return a value";
 }
 
+const char *ReturnFromVoidError::getId() const { return "return-from-void"; }
+
 IncompatibleReturnTypeError::IncompatibleReturnTypeError(
     Location p_location, const PType *p_expected, const PType *p_actual)
     : Error{p_location}, m_expected{p_expected}, m_actual{p_actual} {}
@@ -171,3 +263,7 @@ std::string IncompatibleReturnTypeError::getMessage() const {
          "' from a function with return type '" +
          std::string{m_expected->getPTypeCString()} + "'";
 }
+
+const char *IncompatibleReturnTypeError::getId() const {
+  return "incompatible-return-type";
+}
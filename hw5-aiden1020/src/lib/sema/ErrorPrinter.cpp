@@ -1,30 +1,237 @@
 #include "sema/ErrorPrinter.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <string>
+#include <utility>
 
 #include "AST/ast.hpp"
 
 extern FILE *yyin;
-extern long line_positions[];
+
+static constexpr size_t kMaxLineLength = 511;
 
 ErrorPrinter::ErrorPrinter(std::FILE *p_file) : m_file{p_file} {}
 
+ErrorPrinter::ErrorPrinter(std::FILE *p_file, Format p_format,
+                           std::string p_source_path)
+    : m_file{p_file}, m_format{p_format},
+      m_source_path{std::move(p_source_path)} {}
+
+bool ErrorPrinter::loadSource() const {
+  if (std::fseek(yyin, 0, SEEK_SET) != 0) {
+    return false;
+  }
+  char buffer[4096];
+  size_t num_read = 0;
+  while ((num_read = std::fread(buffer, 1, sizeof(buffer), yyin)) > 0) {
+    m_source.append(buffer, num_read);
+  }
+  m_line_index.reset(new LineIndex(m_source.data(), m_source.size()));
+  return true;
+}
+
+std::string ErrorPrinter::getSourceLine(uint32_t p_line) const {
+  if ((m_line_index || loadSource()) && p_line >= 1 &&
+      p_line <= m_line_index->getNumLines()) {
+    return m_source.substr(
+        m_line_index->getLineOffset(p_line),
+        std::min(m_line_index->getLineLength(p_line), kMaxLineLength));
+  }
+  return "";
+}
+
 void ErrorPrinter::print(const Error &p_error) const {
+  print(p_error.getId(), p_error.getLocation(), p_error.getMessage());
+}
+
+void ErrorPrinter::print(const char *p_id, Location p_location,
+                         const std::string &p_message,
+                         const std::vector<Location> &p_repeats) const {
+  switch (m_format) {
+  case Format::kText:
+    printText(p_location, p_message, p_repeats);
+    break;
+  case Format::kJson:
+    printJson(p_id, p_location, p_message, p_repeats);
+    break;
+  case Format::kSarif:
+    printSarifResult(p_id, p_location, p_message, p_repeats);
+    break;
+  }
+  ++m_num_printed;
+}
+
+void ErrorPrinter::printNote(const char *p_id, const std::string &p_message,
+                             uint32_t p_count) const {
+  switch (m_format) {
+  case Format::kText:
+    std::fprintf(m_file, "<Note> %s\n", p_message.c_str());
+    break;
+  case Format::kJson:
+    std::fputs("{\"file\":", m_file);
+    printJsonString(m_source_path);
+    std::fprintf(m_file, ",\"id\":\"%s\",\"severity\":\"note\",\"message\":",
+                 p_id);
+    printJsonString(p_message);
+    std::fprintf(m_file, ",\"count\":%u}\n", p_count);
+    break;
+  case Format::kSarif:
+    m_sarif_notes.push_back({p_id, p_message, p_count});
+    break;
+  }
+}
+
+void ErrorPrinter::printText(Location p_location, const std::string &p_message,
+                             const std::vector<Location> &p_repeats) const {
   std::fprintf(m_file, "<Error> Found in line %d, column %d: %s\n",
-               p_error.getLocation().line, p_error.getLocation().col,
-               p_error.getMessage().c_str());
+               p_location.line, p_location.col, p_message.c_str());
 
   constexpr uint32_t kIndentionWidth = 4;
-  if (std::fseek(yyin, line_positions[p_error.getLocation().line], SEEK_SET) ==
-      0) {
-    char buffer[512];
-    std::fgets(buffer, sizeof(buffer), yyin);
-    std::fprintf(m_file, "%*s%s", kIndentionWidth, "", buffer);
-    std::fprintf(m_file, "%*s\n", kIndentionWidth + p_error.getLocation().col,
-                 "^");
+  const uint32_t line = p_location.line;
+  if ((m_line_index || loadSource()) && line >= 1 &&
+      line <= m_line_index->getNumLines()) {
+    // The newline is printed along with the line, if there is one.
+    const size_t length =
+        std::min(m_line_index->getLineLength(line) +
+                     m_line_index->hasNewline(line),
+                 kMaxLineLength);
+    std::fprintf(m_file, "%*s%.*s", kIndentionWidth, "",
+                 static_cast<int>(length),
+                 m_source.data() + m_line_index->getLineOffset(line));
+    std::fprintf(m_file, "%*s\n", kIndentionWidth + p_location.col, "^");
   } else {
     std::fprintf(m_file, "Fail to reposition the yyin file stream.\n");
   }
+  if (!p_repeats.empty()) {
+    std::fprintf(m_file, "<Note> The same error occurs %zu more time%s, in",
+                 p_repeats.size(), p_repeats.size() > 1 ? "s" : "");
+    for (size_t i = 0; i < p_repeats.size(); ++i) {
+      std::fprintf(m_file, "%s line %u, column %u", i > 0 ? ";" : "",
+                   p_repeats[i].line, p_repeats[i].col);
+    }
+    std::fputs(".\n", m_file);
+  }
+}
+
+void ErrorPrinter::printJsonString(const std::string &p_text) const {
+  std::fputc('"', m_file);
+  for (const char c : p_text) {
+    switch (c) {
+    case '"':
+      std::fputs("\\\"", m_file);
+      break;
+    case '\\':
+      std::fputs("\\\\", m_file);
+      break;
+    case '\t':
+      std::fputs("\\t", m_file);
+      break;
+    case '\r':
+      std::fputs("\\r", m_file);
+      break;
+    case '\n':
+      std::fputs("\\n", m_file);
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        std::fprintf(m_file, "\\u%04x", static_cast<unsigned char>(c));
+      } else {
+        std::fputc(c, m_file);
+      }
+    }
+  }
+  std::fputc('"', m_file);
+}
+
+void ErrorPrinter::printJson(const char *p_id, Location p_location,
+                             const std::string &p_message,
+                             const std::vector<Location> &p_repeats) const {
+  std::fputs("{\"file\":", m_file);
+  printJsonString(m_source_path);
+  std::fprintf(m_file, ",\"line\":%u,\"column\":%u,\"id\":\"%s\",",
+               p_location.line, p_location.col, p_id);
+  std::fputs("\"severity\":\"error\",\"message\":", m_file);
+  printJsonString(p_message);
+  std::fprintf(m_file, ",\"count\":%zu,\"repeats\":[", p_repeats.size() + 1);
+  for (size_t i = 0; i < p_repeats.size(); ++i) {
+    std::fprintf(m_file, "%s{\"line\":%u,\"column\":%u}", i > 0 ? "," : "",
+                 p_repeats[i].line, p_repeats[i].col);
+  }
+  std::fputs("],\"excerpt\":", m_file);
+  printJsonString(getSourceLine(p_location.line));
+  std::fputs("}\n", m_file);
+}
+
+static void printSarifHeader(std::FILE *p_file) {
+  std::fputs("{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+             "\"version\":\"2.1.0\",\"runs\":[{\"tool\":{\"driver\":"
+             "{\"name\":\"compiler\"}},\"results\":[",
+             p_file);
+}
+
+void ErrorPrinter::printSarifResult(
+    const char *p_id, Location p_location, const std::string &p_message,
+    const std::vector<Location> &p_repeats) const {
+  if (m_num_printed == 0) {
+    printSarifHeader(m_file);
+  } else {
+    std::fputc(',', m_file);
+  }
+  std::fprintf(m_file,
+               "\n{\"ruleId\":\"%s\",\"level\":\"error\",\"message\":{\"text\":",
+               p_id);
+  printJsonString(p_message);
+  std::fputs("},\"locations\":[{\"physicalLocation\":{\"artifactLocation\":"
+             "{\"uri\":",
+             m_file);
+  printJsonString(m_source_path);
+  std::fprintf(m_file,
+               "},\"region\":{\"startLine\":%u,\"startColumn\":%u,"
+               "\"snippet\":{\"text\":",
+               p_location.line, p_location.col);
+  printJsonString(getSourceLine(p_location.line));
+  std::fputs("}}}}]", m_file);
+  if (!p_repeats.empty()) {
+    std::fputs(",\"relatedLocations\":[", m_file);
+    for (size_t i = 0; i < p_repeats.size(); ++i) {
+      std::fputs(i > 0 ? ",{" : "{", m_file);
+      std::fputs("\"physicalLocation\":{\"artifactLocation\":{\"uri\":",
+                 m_file);
+      printJsonString(m_source_path);
+      std::fprintf(m_file,
+                   "},\"region\":{\"startLine\":%u,\"startColumn\":%u}}}",
+                   p_repeats[i].line, p_repeats[i].col);
+    }
+    std::fputc(']', m_file);
+  }
+  std::fprintf(m_file, ",\"occurrenceCount\":%zu}", p_repeats.size() + 1);
+}
+
+void ErrorPrinter::finish() const {
+  if (m_format != Format::kSarif) {
+    return;
+  }
+  if (m_num_printed == 0) {
+    printSarifHeader(m_file);
+  }
+  std::fputs("\n]", m_file);
+  if (!m_sarif_notes.empty()) {
+    std::fputs(",\"invocations\":[{\"executionSuccessful\":true,"
+               "\"toolExecutionNotifications\":[",
+               m_file);
+    for (size_t i = 0; i < m_sarif_notes.size(); ++i) {
+      const auto &note = m_sarif_notes[i];
+      std::fprintf(m_file,
+                   "%s\n{\"descriptor\":{\"id\":\"%s\"},\"level\":\"note\","
+                   "\"message\":{\"text\":",
+                   i > 0 ? "," : "", note.m_id);
+      printJsonString(note.m_message);
+      std::fprintf(m_file, "},\"properties\":{\"count\":%u}}", note.m_count);
+    }
+    std::fputs("\n]}]", m_file);
+    m_sarif_notes.clear();
+  }
+  std::fputs("}]}\n", m_file);
 }
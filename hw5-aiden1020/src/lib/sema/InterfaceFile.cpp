@@ -0,0 +1,193 @@
+#include "sema/InterfaceFile.hpp"
+#include "visitor/AstNodeInclude.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace {
+const char *kPrimitiveTypeNames[] = {"void", "integer", "real", "boolean",
+                                     "string"};
+
+std::string typeStringOf(const PType &p_type) {
+    std::string type =
+        kPrimitiveTypeNames[static_cast<size_t>(p_type.getPrimitiveType())];
+    for (const auto dim : p_type.getDimensions()) {
+        type += "[" + std::to_string(dim) + "]";
+    }
+    return type;
+}
+
+/// @return `nullptr` if the type is malformed.
+PType *parseType(const std::string &p_type) {
+    const auto bracket = p_type.find('[');
+    const auto name = p_type.substr(0, bracket);
+    PType *type = nullptr;
+    for (size_t i = 0; i < sizeof(kPrimitiveTypeNames) / sizeof(char *); ++i) {
+        if (name == kPrimitiveTypeNames[i]) {
+            type = new PType(static_cast<PType::PrimitiveTypeEnum>(i));
+        }
+    }
+    if (!type) {
+        return nullptr;
+    }
+
+    std::vector<uint64_t> dims;
+    for (auto pos = bracket; pos != std::string::npos;
+         pos = p_type.find('[', pos + 1)) {
+        dims.push_back(std::strtoull(p_type.c_str() + pos + 1, nullptr, 10));
+    }
+    type->setDimensions(dims);
+    return type;
+}
+
+std::string valueStringOf(const Constant &p_constant) {
+    char buffer[64];
+    switch (p_constant.getTypePtr()->getPrimitiveType()) {
+    case PType::PrimitiveTypeEnum::kRealType:
+        snprintf(buffer, sizeof(buffer), "%a", p_constant.real());
+        return buffer;
+    case PType::PrimitiveTypeEnum::kStringType: {
+        // Strings may contain spaces; they are written byte by byte.
+        std::string hex;
+        for (const char *c = p_constant.getConstantValueCString(); *c; ++c) {
+            snprintf(buffer, sizeof(buffer), "%02x",
+                     static_cast<unsigned char>(*c));
+            hex += buffer;
+        }
+        return hex.empty() ? "-" : hex;
+    }
+    default:
+        return p_constant.getConstantValueCString();
+    }
+}
+
+/// @return `nullptr` if the value is malformed.
+Constant *parseConstant(PType *p_type, const std::string &p_value) {
+    Constant::ConstantValue value;
+    switch (p_type->getPrimitiveType()) {
+    case PType::PrimitiveTypeEnum::kIntegerType:
+        value.integer = std::strtoll(p_value.c_str(), nullptr, 10);
+        break;
+    case PType::PrimitiveTypeEnum::kRealType:
+        value.real = std::strtod(p_value.c_str(), nullptr);
+        break;
+    case PType::PrimitiveTypeEnum::kBoolType:
+        value.boolean = p_value == "true";
+        break;
+    case PType::PrimitiveTypeEnum::kStringType: {
+        const std::string hex = p_value == "-" ? "" : p_value;
+        value.string = static_cast<char *>(std::malloc(hex.size() / 2 + 1));
+        for (size_t i = 0; i < hex.size() / 2; ++i) {
+            value.string[i] = static_cast<char>(
+                std::strtoul(hex.substr(2 * i, 2).c_str(), nullptr, 16));
+        }
+        value.string[hex.size() / 2] = '\0';
+        break;
+    }
+    default:
+        return nullptr;
+    }
+    return new Constant(PTypeSharedPtr{p_type}, value);
+}
+} // namespace
+
+void InterfaceFile::write(const ProgramNode &p_program, std::FILE *p_out) {
+    for (const auto &decl_node : p_program.getDeclNodes()) {
+        for (const auto &variable : decl_node->getVariables()) {
+            const Constant *constant = variable->getConstantPtr();
+            if (constant) {
+                fprintf(p_out, "const %s %s %s\n", variable->getNameCString(),
+                        typeStringOf(*variable->getTypePtr()).c_str(),
+                        valueStringOf(*constant).c_str());
+            } else {
+                fprintf(p_out, "var %s %s\n", variable->getNameCString(),
+                        typeStringOf(*variable->getTypePtr()).c_str());
+            }
+        }
+    }
+
+    for (const auto &func_node : p_program.getFuncNodes()) {
+        if (!func_node->getBody()) {
+            continue;
+        }
+        fprintf(p_out, "function %s %s", func_node->getNameCString(),
+                typeStringOf(*func_node->getTypePtr()).c_str());
+        for (const auto &parameter : func_node->getParameters()) {
+            for (const auto &variable : parameter->getVariables()) {
+                fprintf(p_out, " %s",
+                        typeStringOf(*variable->getTypePtr()).c_str());
+            }
+        }
+        fprintf(p_out, "\n");
+    }
+}
+
+std::unique_ptr<InterfaceFile> InterfaceFile::read(const std::string &p_path) {
+    std::ifstream in(p_path);
+    if (!in) {
+        fprintf(stderr, "Failed to open the interface %s\n", p_path.c_str());
+        return nullptr;
+    }
+
+    std::unique_ptr<InterfaceFile> interface(new InterfaceFile);
+    std::string line;
+    for (uint32_t line_num = 1; std::getline(in, line); ++line_num) {
+        if (line.empty()) {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string kind, name, type_string;
+        fields >> kind >> name >> type_string;
+        // The imported symbols have no location in the source being compiled.
+        const std::vector<IdInfo> ids{IdInfo(0, 0, name.c_str())};
+        PType *type = parseType(type_string);
+        bool is_valid = type != nullptr;
+
+        if (is_valid && kind == "var") {
+            interface->m_decl_nodes.emplace_back(new DeclNode(0, 0, &ids, type));
+        } else if (is_valid && kind == "const") {
+            std::string value;
+            fields >> value;
+            Constant *constant = parseConstant(type, value);
+            is_valid = constant != nullptr;
+            if (is_valid) {
+                interface->m_decl_nodes.emplace_back(new DeclNode(
+                    0, 0, &ids, new ConstantValueNode(0, 0, constant)));
+            } else {
+                delete type;
+            }
+        } else if (is_valid && kind == "function") {
+            FunctionNode::DeclNodes parameters;
+            std::string parameter_type;
+            while (is_valid && fields >> parameter_type) {
+                PType *type = parseType(parameter_type);
+                is_valid = type != nullptr;
+                if (is_valid) {
+                    const std::vector<IdInfo> parameter_ids{IdInfo(
+                        0, 0, std::to_string(parameters.size()).c_str())};
+                    parameters.emplace_back(
+                        new DeclNode(0, 0, &parameter_ids, type));
+                }
+            }
+            if (is_valid) {
+                interface->m_func_nodes.emplace_back(new FunctionNode(
+                    0, 0, name.c_str(), parameters, type, nullptr));
+            } else {
+                delete type;
+            }
+        } else {
+            delete type;
+            is_valid = false;
+        }
+
+        if (!is_valid) {
+            fprintf(stderr, "%s:%u: malformed interface line: %s\n",
+                    p_path.c_str(), line_num, line.c_str());
+            return nullptr;
+        }
+    }
+    return interface;
+}
@@ -0,0 +1,86 @@
+#include "sema/NameResolver.hpp"
+#include "visitor/AstNodeInclude.hpp"
+
+//
+// The scopes are pushed exactly as the semantic analyzer opened them, so that
+// a name resolves to the entry it was checked against. Declarations hold no
+// references, since the initial values of constants are literals.
+//
+
+void NameResolver::enterScope(const AstNode &p_node) {
+    m_symbol_manager.pushScope(m_symbol_tables.at(&p_node));
+}
+
+void NameResolver::leaveScope() {
+    m_symbol_manager.popScope();
+}
+
+void NameResolver::visit(ProgramNode &p_program) {
+    enterScope(p_program);
+    p_program.visitChildNodes(*this);
+    leaveScope();
+}
+
+void NameResolver::visit(FunctionNode &p_function) {
+    // The parameters and the body share the scope of the function.
+    enterScope(p_function);
+    p_function.visitBodyChildNodes(*this);
+    leaveScope();
+}
+
+void NameResolver::visit(CompoundStatementNode &p_compound_statement) {
+    enterScope(p_compound_statement);
+    p_compound_statement.visitChildNodes(*this);
+    leaveScope();
+}
+
+void NameResolver::visit(PrintNode &p_print) {
+    p_print.visitChildNodes(*this);
+}
+
+void NameResolver::visit(BinaryOperatorNode &p_bin_op) {
+    p_bin_op.visitChildNodes(*this);
+}
+
+void NameResolver::visit(UnaryOperatorNode &p_un_op) {
+    p_un_op.visitChildNodes(*this);
+}
+
+void NameResolver::visit(FunctionInvocationNode &p_func_invocation) {
+    p_func_invocation.setSymbolEntry(
+        m_symbol_manager.lookup(p_func_invocation.getName()));
+    p_func_invocation.visitChildNodes(*this);
+}
+
+void NameResolver::visit(VariableReferenceNode &p_variable_ref) {
+    p_variable_ref.setSymbolEntry(
+        m_symbol_manager.lookup(p_variable_ref.getName()));
+    p_variable_ref.visitChildNodes(*this);
+}
+
+void NameResolver::visit(AssignmentNode &p_assignment) {
+    p_assignment.visitChildNodes(*this);
+}
+
+void NameResolver::visit(ReadNode &p_read) {
+    p_read.visitChildNodes(*this);
+}
+
+void NameResolver::visit(IfNode &p_if) {
+    p_if.visitChildNodes(*this);
+}
+
+void NameResolver::visit(WhileNode &p_while) {
+    p_while.visitChildNodes(*this);
+}
+
+void NameResolver::visit(ForNode &p_for) {
+    // The loop variable is bound through the lvalue of the initial assignment.
+    enterScope(p_for);
+    p_for.visitChildNodes(*this);
+    leaveScope();
+}
+
+void NameResolver::visit(ReturnNode &p_return) {
+    p_return.visitChildNodes(*this);
+}
@@ -1,6 +1,6 @@
 #include "AST/PType.hpp"
 #include "sema/Error.hpp"
-#include "sema/ErrorPrinter.hpp"
+#include "sema/DiagnosticEngine.hpp"
 #include "sema/SemanticAnalyzer.hpp"
 #include "visitor/AstNodeInclude.hpp"
 
@@ -42,6 +42,39 @@ void SemanticAnalyzer::visit(ProgramNode &p_program) {
                                             p_program.getNameCString()));
     }
 
+    if (m_prelude) {
+        for (const auto &prelude_entry : m_prelude->getEntries()) {
+            if (prelude_entry.getKind() == SymbolEntry::KindEnum::kProgramKind) {
+                continue;
+            }
+            auto *entry =
+                prelude_entry.getKind() == SymbolEntry::KindEnum::kFunctionKind
+                    ? m_symbol_manager.addSymbol(
+                          prelude_entry.getName(), prelude_entry.getKind(),
+                          prelude_entry.getTypePtr(),
+                          prelude_entry.getAttribute().parameters())
+                    : m_symbol_manager.addSymbol(
+                          prelude_entry.getName(), prelude_entry.getKind(),
+                          prelude_entry.getTypePtr(),
+                          prelude_entry.getAttribute().constant());
+            if (!entry) {
+                printError(SymbolRedeclarationError(
+                    p_program.getLocation(), prelude_entry.getNameCString()));
+            }
+        }
+    }
+
+    // The declarations of an interface are only visited to add their symbols,
+    // so that they count as declared before everything in the program.
+    for (const auto *interface : m_imports) {
+        for (const auto &decl_node : interface->getDeclNodes()) {
+            decl_node->accept(*this);
+        }
+        for (const auto &func_node : interface->getFuncNodes()) {
+            func_node->accept(*this);
+        }
+    }
+
     p_program.visitChildNodes(*this);
 
     m_returned_type_stack.pop();
@@ -86,7 +119,7 @@ bool SemanticAnalyzer::isShadowingLoopVar(const std::string &p_name) const {
 }
 
 bool SemanticAnalyzer::isRedeclaringSymbol(const std::string &p_name) const {
-    return m_symbol_manager.getCurrentTable()->lookup(p_name);
+    return m_symbol_manager.lookupInCurrentScope(p_name);
 }
 
 void SemanticAnalyzer::visit(VariableNode &p_variable) {
@@ -104,11 +137,18 @@ void SemanticAnalyzer::visit(VariableNode &p_variable) {
 
     p_variable.visitChildNodes(*this);
 
+    // A declaration recovered from a syntax error has the error type, which
+    // has been reported; the symbol is ill-formed.
+    if (entry && p_variable.getTypePtr()->isError()) {
+        m_error_entry_set.insert(&entry->getName());
+        return;
+    }
+
     // The size of an array should be positive. Notice that size error doesn't
     // stop the array from being added to the symbol table; however, the symbol is
     // ill-formed.
     if (entry && hasNonPositiveDimension(p_variable.getTypePtr())) {
-        m_error_entry_set.insert(entry);
+        m_error_entry_set.insert(&entry->getName());
         printError(NonPositiveArrayDimensionError(
             p_variable.getLocation(), p_variable.getNameCString()));
     }
@@ -129,6 +169,11 @@ void SemanticAnalyzer::visit(FunctionNode &p_function) {
             p_function.getName(), SymbolEntry::KindEnum::kFunctionKind,
             p_function.getTypePtr(), &p_function.getParameters());
         assert(entry);
+        // Recovered from a syntax error in its parameters, which has been
+        // reported; the symbol is ill-formed.
+        if (p_function.getTypePtr()->isError()) {
+            m_error_entry_set.insert(&entry->getName());
+        }
     }
 
     m_symbol_manager.pushScope();
@@ -380,8 +425,8 @@ void SemanticAnalyzer::visit(FunctionInvocationNode &p_func_invocation) {
     p_func_invocation.visitChildNodes(*this);
 
     const SymbolEntry *entry = m_symbol_manager.lookup(p_func_invocation.getName());
-    if (entry && m_error_entry_set.find(const_cast<SymbolEntry *>(entry)) !=
-        m_error_entry_set.end()) {
+    if (entry && m_error_entry_set.find(&entry->getName()) !=
+                     m_error_entry_set.end()) {
         p_func_invocation.setInferredType(
             new PType(PType::PrimitiveTypeEnum::kErrorType));
         return;
@@ -434,8 +479,8 @@ void SemanticAnalyzer::visit(VariableReferenceNode &p_variable_ref) {
     p_variable_ref.visitChildNodes(*this);
 
     const SymbolEntry *entry = m_symbol_manager.lookup(p_variable_ref.getName());
-    if (entry && m_error_entry_set.find(const_cast<SymbolEntry *>(entry)) !=
-        m_error_entry_set.end()) {
+    if (entry && m_error_entry_set.find(&entry->getName()) !=
+                     m_error_entry_set.end()) {
         p_variable_ref.setInferredType(
             new PType(PType::PrimitiveTypeEnum::kErrorType));
         return;
@@ -583,8 +628,7 @@ void SemanticAnalyzer::visit(ReadNode &p_read) {
         m_symbol_manager.lookup(p_read.getTarget().getName());
     assert(entry && "Shouldn't reach here. This should be caught during the"
                     "visits of child nodes");
-    if (m_error_entry_set.find(const_cast<SymbolEntry *>(entry)) !=
-        m_error_entry_set.end()) {
+    if (m_error_entry_set.find(&entry->getName()) != m_error_entry_set.end()) {
         return;
     }
     // 2. The kind of symbol of the variable reference cannot be constant or
@@ -669,7 +713,7 @@ void SemanticAnalyzer::visit(ReturnNode &p_return) {
 }
 
 void SemanticAnalyzer::printError(const Error& p_error) {
-    m_error_printer.print(p_error);
+    m_diagnostics.report(p_error);
     m_has_error = true;
 }
 
@@ -34,9 +34,8 @@ SymbolEntry *SymbolTable::addSymbol(const std::string &p_name,
                                     const size_t p_level,
                                     const PType *const p_p_type,
                                     const Constant *const p_constant) {
-    m_entries.emplace_back(
-        new SymbolEntry(p_name, p_kind, p_level, p_p_type, p_constant));
-    return m_entries.back().get();
+    m_entries.emplace_back(p_name, p_kind, p_level, p_p_type, p_constant);
+    return &m_entries.back();
 }
 
 SymbolEntry *
@@ -45,15 +44,14 @@ SymbolTable::addSymbol(const std::string &p_name,
                        const size_t p_level,
                        const PType *const p_p_type,
                        const FunctionNode::DeclNodes *const p_parameters) {
-    m_entries.emplace_back(
-        new SymbolEntry(p_name, p_kind, p_level, p_p_type, p_parameters));
-    return m_entries.back().get();
+    m_entries.emplace_back(p_name, p_kind, p_level, p_p_type, p_parameters);
+    return &m_entries.back();
 }
 
 const SymbolEntry *SymbolTable::lookup(const std::string &p_name) const {
     for (const auto &entry : m_entries) {
-        if (entry->getName() == p_name) {
-            return entry.get();
+        if (entry.getName() == p_name) {
+            return &entry;
         }
     }
     return nullptr;
@@ -68,16 +66,15 @@ void SymbolTable::dump() const {
                 "----------------------------------------------------\n");
 
     std::string type_string;
-    auto construct_attr_string = [&type_string](const auto &p_entry_ptr) {
-        if (p_entry_ptr->getKind() == SymbolEntry::KindEnum::kFunctionKind) {
+    auto construct_attr_string = [&type_string](const SymbolEntry &p_entry) {
+        if (p_entry.getKind() == SymbolEntry::KindEnum::kFunctionKind) {
             const FunctionNode::DeclNodes *const parameters_ptr =
-                p_entry_ptr->getAttribute().parameters();
+                p_entry.getAttribute().parameters();
             type_string =
                 FunctionNode::getParametersTypeString(*parameters_ptr);
             return type_string.c_str();
         } else {
-            const Constant *const constant =
-                p_entry_ptr->getAttribute().constant();
+            const Constant *const constant = p_entry.getAttribute().constant();
             if (constant) {
                 return constant->getConstantValueCString();
             } else {
@@ -86,17 +83,17 @@ void SymbolTable::dump() const {
         }
     };
 
-    auto dump_entry = [&construct_attr_string](const auto &p_entry_ptr) {
+    auto dump_entry = [&construct_attr_string](const SymbolEntry &p_entry) {
         static const char *kKindStrings[] = {"program",  "function", "parameter",
                                              "variable", "loop_var", "constant"};
 
-        std::printf("%-33s", p_entry_ptr->getNameCString());
+        std::printf("%-33s", p_entry.getNameCString());
         std::printf("%-11s",
-                    kKindStrings[static_cast<size_t>(p_entry_ptr->getKind())]);
-        std::printf("%lu%-10s", p_entry_ptr->getLevel(),
-                    (p_entry_ptr->getLevel() != 0) ? "(local)" : "(global)");
-        std::printf("%-17s", p_entry_ptr->getTypePtr()->getPTypeCString());
-        std::printf("%-11s\n", construct_attr_string(p_entry_ptr));
+                    kKindStrings[static_cast<size_t>(p_entry.getKind())]);
+        std::printf("%lu%-10s", p_entry.getLevel(),
+                    (p_entry.getLevel() != 0) ? "(local)" : "(global)");
+        std::printf("%-17s", p_entry.getTypePtr()->getPTypeCString());
+        std::printf("%-11s\n", construct_attr_string(p_entry));
     };
 
     for_each(m_entries.begin(), m_entries.end(), dump_entry);
@@ -109,22 +106,34 @@ void SymbolTable::dump() const {
 // > SymbolManager
 // ===========================================
 void SymbolManager::pushScope() {
-    m_tables.emplace_back(std::make_unique<SymbolTable>());
+    m_scopes.push_back({m_entries.size(), nullptr});
 }
 
 void SymbolManager::pushScope(SymbolManager::Table p_table) {
-    m_tables.push_back(std::move(p_table));
+    m_scopes.push_back({m_entries.size(), std::move(p_table)});
 }
 
 SymbolManager::Table SymbolManager::popScope() {
-    assert(getCurrentTable() && "Shouldn't popScope() without pushing any scope");
+    assert(!m_scopes.empty() && "Shouldn't popScope() without pushing any scope");
+
+    auto &scope = m_scopes.back();
+    auto table = std::move(scope.m_table);
+    if (!table && scope.m_begin != m_entries.size()) {
+        table = std::make_shared<const SymbolTable>(std::vector<SymbolEntry>(
+            m_entries.begin() + scope.m_begin, m_entries.end()));
+        while (m_entries.size() > scope.m_begin) {
+            m_entries.pop_back();
+        }
+    }
+    m_scopes.pop_back();
 
     if (m_opt_dmp) {
-        getCurrentTable()->dump();
+        if (table) {
+            table->dump();
+        } else {
+            SymbolTable().dump();
+        }
     }
-
-    auto table = std::move(m_tables.back());
-    m_tables.pop_back();
     return table;
 }
 
@@ -133,14 +142,15 @@ SymbolEntry *SymbolManager::addSymbol(const std::string &p_name,
                                       const SymbolEntry::KindEnum p_kind,
                                       const PType *const p_p_type,
                                       const AttributeType *const p_attribute) {
-    if (getCurrentTable()->lookup(p_name)) {
+    if (lookupInCurrentScope(p_name)) {
         return nullptr;
     }
 
-    auto& current_table = m_tables.back();
-    auto *entry = current_table->addSymbol(
-        p_name, p_kind, getCurrentLevel(), p_p_type, p_attribute);
-    return entry;
+    assert(!m_scopes.back().m_table &&
+           "Shouldn't addSymbol() to a scope pushed as a frozen table");
+    m_entries.emplace_back(p_name, p_kind, getCurrentLevel(), p_p_type,
+                           p_attribute);
+    return &m_entries.back();
 }
 
 // explicit instantiation
@@ -151,22 +161,46 @@ template SymbolEntry *SymbolManager::addSymbol<FunctionNode::DeclNodes>(
     const std::string &, const SymbolEntry::KindEnum, const PType *const,
     const FunctionNode::DeclNodes *const);
 
+namespace {
+const SymbolEntry *lookupInRange(const std::deque<SymbolEntry> &p_entries,
+                                 const size_t p_begin, const size_t p_end,
+                                 const std::string &p_name) {
+    for (size_t i = p_end; i > p_begin; --i) {
+        if (p_entries[i - 1].getName() == p_name) {
+            return &p_entries[i - 1];
+        }
+    }
+    return nullptr;
+}
+} // namespace
+
 const SymbolEntry *SymbolManager::lookup(const std::string &p_name) const {
-    for (auto it = m_tables.rbegin(); it != m_tables.rend(); ++it) {
-        if (auto *entry = (*it)->lookup(p_name)) {
+    // A scope ends where the one inside it begins; a scope pushed as a table
+    // has no entries on the stack.
+    size_t end = m_entries.size();
+    for (auto it = m_scopes.rbegin(); it != m_scopes.rend(); ++it) {
+        const auto *entry =
+            it->m_table ? it->m_table->lookup(p_name)
+                        : lookupInRange(m_entries, it->m_begin, end, p_name);
+        if (entry) {
             return entry;
         }
+        end = it->m_begin;
     }
     return nullptr;
 }
 
-const SymbolTable *SymbolManager::getCurrentTable() const {
-    if (m_tables.empty()) {
+const SymbolEntry *
+SymbolManager::lookupInCurrentScope(const std::string &p_name) const {
+    if (m_scopes.empty()) {
         return nullptr;
     }
-    return m_tables.back().get();
+    const auto &scope = m_scopes.back();
+    return scope.m_table ? scope.m_table->lookup(p_name)
+                         : lookupInRange(m_entries, scope.m_begin,
+                                         m_entries.size(), p_name);
 }
 
 size_t SymbolManager::getCurrentLevel() const {
-    return m_tables.size() - 1 /* global scope is at level 0 */;
+    return m_scopes.size() - 1 /* global scope is at level 0 */;
 }
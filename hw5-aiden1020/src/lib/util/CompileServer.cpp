@@ -0,0 +1,153 @@
+#include "util/CompileServer.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+namespace {
+/// @brief The largest source text a request may carry.
+constexpr size_t kMaxSourceTextSize = 16 << 20;
+}  // namespace
+
+int CompileServer::run() {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (m_socket_path.size() >= sizeof(address.sun_path)) {
+    fprintf(stderr, "Socket path is too long: %s\n", m_socket_path.c_str());
+    return -1;
+  }
+  strcpy(address.sun_path, m_socket_path.c_str());
+
+  const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0) {
+    perror("socket() failed");
+    return -1;
+  }
+  // A socket left behind by a previous server would make `bind` fail.
+  unlink(m_socket_path.c_str());
+  if (bind(listener, reinterpret_cast<const sockaddr *>(&address),
+           sizeof(address)) < 0 ||
+      listen(listener, 16) < 0) {
+    perror("bind() failed");
+    close(listener);
+    return -1;
+  }
+  // A client that hangs up early must not take the server down.
+  signal(SIGPIPE, SIG_IGN);
+  fprintf(stderr, "Listening on %s\n", m_socket_path.c_str());
+
+  for (;;) {
+    const int connection = accept(listener, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno != EINTR) {
+        perror("accept() failed");
+      }
+      continue;
+    }
+    serve(connection);
+    close(connection);
+  }
+}
+
+bool CompileServer::readRequest(FILE *p_in, CompileRequest &p_request) {
+  char *line = nullptr;
+  size_t capacity = 0;
+  ssize_t length = 0;
+  bool is_complete = false;
+  while ((length = getline(&line, &capacity, p_in)) > 0) {
+    std::string text(line, length);
+    if (text.back() == '\n') {
+      text.pop_back();
+    }
+    if (text.empty()) {
+      is_complete = !p_request.m_source_path.empty();
+      break;
+    }
+
+    std::istringstream fields(text);
+    std::string key;
+    fields >> key >> std::ws;
+    if (key == "source") {
+      std::getline(fields, p_request.m_source_path);
+    } else if (key == "text") {
+      // The size comes from the client; it is checked before anything is
+      // allocated, since the server itself must not fail on a bad request.
+      size_t size = 0;
+      if (!(fields >> p_request.m_source_path >> size) ||
+          size > kMaxSourceTextSize) {
+        break;
+      }
+      p_request.m_source_text.resize(size);
+      if (fread(&p_request.m_source_text[0], 1, size, p_in) != size) {
+        break;
+      }
+      p_request.m_has_source_text = true;
+    } else if (key == "save-path") {
+      std::getline(fields, p_request.m_save_path);
+    } else if (key == "flag") {
+      // An option may take arguments, e.g., `flag --cache-dir <dir>`.
+      std::string flag;
+      while (fields >> flag) {
+        p_request.m_flags.push_back(flag);
+      }
+    } else {
+      break;
+    }
+  }
+  free(line);
+  return is_complete;
+}
+
+void CompileServer::serve(int p_connection) {
+  CompileRequest request;
+  FILE *in = fdopen(dup(p_connection), "r");
+  const bool is_valid = in && readRequest(in, request);
+  if (in) {
+    fclose(in);
+  }
+  if (!is_valid) {
+    dprintf(p_connection, "error malformed request\n");
+    return;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  // Anything still buffered would otherwise be printed by the child as well.
+  fflush(stdout);
+  fflush(stderr);
+  const pid_t child = fork();
+  if (child == 0) {
+    dup2(p_connection, STDOUT_FILENO);
+    dup2(p_connection, STDERR_FILENO);
+    close(p_connection);
+    // The compiler exits on its own on errors; `exit` flushes the output.
+    exit(m_compile(request));
+  }
+
+  int status = -1;
+  if (child < 0) {
+    perror("fork() failed");
+  } else {
+    int wait_status = 0;
+    while (waitpid(child, &wait_status, 0) < 0 && errno == EINTR) {
+    }
+    status = WIFEXITED(wait_status) ? WEXITSTATUS(wait_status)
+                                    : 128 + WTERMSIG(wait_status);
+  }
+  const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  dprintf(p_connection, "status %d latency-us %lld\n", status,
+          static_cast<long long>(latency));
+  fprintf(stderr, "%s: status %d, %.3f ms\n", request.m_source_path.c_str(),
+          status, latency / 1000.0);
+}
@@ -0,0 +1,439 @@
+#include "util/HandLexer.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+using TokenKind = HandLexer::TokenKind;
+
+enum CharClass : uint8_t {
+  kOther,
+  kBlank,
+  kLetter,
+  kDigit,
+  kQuote,
+  kSlash,
+};
+
+struct CharClassTable {
+  uint8_t m_classes[256];
+
+  CharClassTable() : m_classes{} {
+    m_classes[static_cast<unsigned char>(' ')] = kBlank;
+    m_classes[static_cast<unsigned char>('\t')] = kBlank;
+    m_classes[static_cast<unsigned char>('\n')] = kBlank;
+    for (int c = 'a'; c <= 'z'; ++c) {
+      m_classes[c] = kLetter;
+      m_classes[c - 'a' + 'A'] = kLetter;
+    }
+    for (int c = '0'; c <= '9'; ++c) {
+      m_classes[c] = kDigit;
+    }
+    m_classes[static_cast<unsigned char>('"')] = kQuote;
+    m_classes[static_cast<unsigned char>('/')] = kSlash;
+  }
+
+  uint8_t operator[](char p_char) const {
+    return m_classes[static_cast<unsigned char>(p_char)];
+  }
+};
+
+const CharClassTable kCharClasses;
+
+bool isIdentifierChar(char p_char) {
+  const uint8_t char_class = kCharClasses[p_char];
+  return char_class == kLetter || char_class == kDigit;
+}
+
+bool isDigit(char p_char) { return p_char >= '0' && p_char <= '9'; }
+
+bool isOctalDigit(char p_char) { return p_char >= '0' && p_char <= '7'; }
+
+size_t countDigits(const char *p_pos) {
+  const char *end = p_pos;
+  while (isDigit(*end)) {
+    ++end;
+  }
+  return end - p_pos;
+}
+
+struct Keyword {
+  const char *m_text;
+  TokenKind m_kind;
+};
+
+const Keyword kKeywords[] = {
+    {"mod", TokenKind::kKwMod},         {"and", TokenKind::kKwAnd},
+    {"or", TokenKind::kKwOr},           {"not", TokenKind::kKwNot},
+    {"var", TokenKind::kKwVar},         {"array", TokenKind::kKwArray},
+    {"of", TokenKind::kKwOf},           {"boolean", TokenKind::kKwBoolean},
+    {"integer", TokenKind::kKwInteger}, {"real", TokenKind::kKwReal},
+    {"string", TokenKind::kKwString},   {"true", TokenKind::kKwTrue},
+    {"false", TokenKind::kKwFalse},     {"def", TokenKind::kKwDef},
+    {"return", TokenKind::kKwReturn},   {"begin", TokenKind::kKwBegin},
+    {"end", TokenKind::kKwEnd},         {"while", TokenKind::kKwWhile},
+    {"do", TokenKind::kKwDo},           {"if", TokenKind::kKwIf},
+    {"then", TokenKind::kKwThen},       {"else", TokenKind::kKwElse},
+    {"for", TokenKind::kKwFor},         {"to", TokenKind::kKwTo},
+    {"print", TokenKind::kKwPrint},     {"read", TokenKind::kKwRead},
+};
+
+constexpr size_t kMinKeywordLength = 2;
+constexpr size_t kMaxKeywordLength = 7;
+constexpr size_t kKeywordTableSize = 64;
+
+/// @brief Maps the keywords to distinct slots; the coefficients were found
+/// by a search over small multipliers.
+size_t hashKeyword(const char *p_text, size_t p_length) {
+  const auto first = static_cast<unsigned char>(p_text[0]);
+  const auto second = static_cast<unsigned char>(p_text[1]);
+  const auto last = static_cast<unsigned char>(p_text[p_length - 1]);
+  return (first + second + 14 * last + p_length) % kKeywordTableSize;
+}
+
+struct KeywordTable {
+  const Keyword *m_slots[kKeywordTableSize];
+
+  KeywordTable() : m_slots{} {
+    for (const auto &keyword : kKeywords) {
+      m_slots[hashKeyword(keyword.m_text, strlen(keyword.m_text))] = &keyword;
+    }
+  }
+};
+
+const KeywordTable kKeywordTable;
+
+/// @return The first of `p_first` and `p_second` in [`p_pos`, `p_end`), or
+/// `p_end`. Neither may be a null character, which pads the input.
+const char *findEither(const char *p_pos, const char *p_end, char p_first,
+                       char p_second) {
+#if defined(__SSE2__)
+  const __m128i first = _mm_set1_epi8(p_first);
+  const __m128i second = _mm_set1_epi8(p_second);
+  for (; p_pos < p_end; p_pos += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_pos));
+    const unsigned matches = _mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(chunk, first), _mm_cmpeq_epi8(chunk, second)));
+    if (matches) {
+      return p_pos + __builtin_ctz(matches);
+    }
+  }
+  return p_end;
+#else
+  while (p_pos < p_end && *p_pos != p_first && *p_pos != p_second) {
+    ++p_pos;
+  }
+  return p_pos;
+#endif
+}
+
+/// @return The first `p_first` in [`p_pos`, `p_end`) that is followed by
+/// `p_second`, or `p_end`. Neither may be a null character.
+const char *findPair(const char *p_pos, const char *p_end, char p_first,
+                     char p_second) {
+#if defined(__SSE2__)
+  // A banner such as `/*****...` has a `*` in every byte; comparing the
+  // chunk one byte ahead as well finds only the `*` of a `*/`.
+  const __m128i first = _mm_set1_epi8(p_first);
+  const __m128i second = _mm_set1_epi8(p_second);
+  for (; p_pos < p_end; p_pos += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_pos));
+    const __m128i next =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_pos + 1));
+    const unsigned matches = _mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(chunk, first), _mm_cmpeq_epi8(next, second)));
+    if (matches) {
+      return p_pos + __builtin_ctz(matches);
+    }
+  }
+  return p_end;
+#else
+  for (; p_pos < p_end; ++p_pos) {
+    if (p_pos[0] == p_first && p_pos[1] == p_second) {
+      return p_pos;
+    }
+  }
+  return p_end;
+#endif
+}
+
+}  // namespace
+
+std::unique_ptr<HandLexer> HandLexer::create(FILE *p_in,
+                                             LineCallback p_on_line) {
+  std::unique_ptr<HandLexer> lexer(new HandLexer(std::move(p_on_line)));
+  auto &buffer = lexer->m_buffer;
+  constexpr size_t kReadSize = 1 << 16;
+  size_t size = 0;
+  for (;;) {
+    buffer.resize(size + kReadSize);
+    const size_t num_read = fread(&buffer[size], 1, kReadSize, p_in);
+    size += num_read;
+    if (num_read < kReadSize) {
+      break;
+    }
+  }
+  if (ferror(p_in)) {
+    return nullptr;
+  }
+  buffer.resize(size + kPadding, '\0');
+
+  lexer->m_line_index.reset(new LineIndex(buffer.data(), size));
+  lexer->m_end = buffer.data() + size;
+  lexer->m_cursor = buffer.data();
+  lexer->m_line_start = buffer.data();
+  lexer->m_next_line_start = lexer->m_line_index->hasNewline(1)
+                                 ? buffer.data() +
+                                       lexer->m_line_index->getLineOffset(2)
+                                 : lexer->m_end + 1;
+  return lexer;
+}
+
+HandLexer::Token HandLexer::next() {
+  for (;;) {
+    const char *pos = skipWhitespace(m_cursor);
+    if (pos >= m_end) {
+      m_cursor = m_end;
+      endLines(m_end, false);
+      // The last line has no newline; pass it on anyway.
+      if (m_line_start < m_end) {
+        m_on_line(m_line, m_line_start, m_end - m_line_start, false);
+        ++m_line;
+        m_line_start = m_end;
+      }
+      return makeToken(TokenKind::kEndOfInput, m_end, 0);
+    }
+
+    switch (kCharClasses[*pos]) {
+      case kLetter: {
+        const char *end = pos + 1;
+        while (isIdentifierChar(*end)) {
+          ++end;
+        }
+        return makeToken(lookUpKeyword(pos, end - pos), pos, end - pos);
+      }
+      case kDigit: {
+        TokenKind kind;
+        const size_t length = scanNumber(pos, kind);
+        return makeToken(kind, pos, length);
+      }
+      case kQuote: {
+        const size_t length = scanString(pos);
+        return length ? makeToken(TokenKind::kStringLiteral, pos, length)
+                      : makeToken(TokenKind::kBadCharacter, pos, 1);
+      }
+      case kSlash:
+        if (pos[1] == '/') {
+          const auto *newline =
+              static_cast<const char *>(memchr(pos, '\n', m_end - pos));
+          const char *end = newline ? newline : m_end;
+          if (pos[2] == '&' && pos[3] != '\0' && strchr("STD", pos[3]) &&
+              (pos[4] == '+' || pos[4] == '-')) {
+            return makeToken(TokenKind::kPseudocomment, pos, end - pos);
+          }
+          m_cursor = end;
+          continue;
+        }
+        if (pos[1] == '*') {
+          endLines(pos, false);
+          m_cursor = skipBlockComment(pos + 2);
+          endLines(m_cursor, true);
+          continue;
+        }
+        return makeToken(TokenKind::kDivide, pos, 1);
+      default:
+        break;
+    }
+
+    switch (*pos) {
+      case ',':
+        return makeToken(TokenKind::kComma, pos, 1);
+      case ';':
+        return makeToken(TokenKind::kSemicolon, pos, 1);
+      case ':':
+        return pos[1] == '=' ? makeToken(TokenKind::kAssign, pos, 2)
+                             : makeToken(TokenKind::kColon, pos, 1);
+      case '(':
+        return makeToken(TokenKind::kLParenthesis, pos, 1);
+      case ')':
+        return makeToken(TokenKind::kRParenthesis, pos, 1);
+      case '[':
+        return makeToken(TokenKind::kLBracket, pos, 1);
+      case ']':
+        return makeToken(TokenKind::kRBracket, pos, 1);
+      case '+':
+        return makeToken(TokenKind::kPlus, pos, 1);
+      case '-':
+        return makeToken(TokenKind::kMinus, pos, 1);
+      case '*':
+        return makeToken(TokenKind::kMultiply, pos, 1);
+      case '<':
+        if (pos[1] == '=') {
+          return makeToken(TokenKind::kLessOrEqual, pos, 2);
+        }
+        if (pos[1] == '>') {
+          return makeToken(TokenKind::kNotEqual, pos, 2);
+        }
+        return makeToken(TokenKind::kLess, pos, 1);
+      case '>':
+        return pos[1] == '=' ? makeToken(TokenKind::kGreaterOrEqual, pos, 2)
+                             : makeToken(TokenKind::kGreater, pos, 1);
+      case '=':
+        return makeToken(TokenKind::kEqual, pos, 1);
+      default:
+        return makeToken(TokenKind::kBadCharacter, pos, 1);
+    }
+  }
+}
+
+HandLexer::Token HandLexer::makeToken(TokenKind p_kind, const char *p_begin,
+                                      size_t p_length) {
+  if (p_begin >= m_next_line_start) {
+    endLines(p_begin, false);
+  }
+  m_cursor = p_begin + p_length;
+  return Token{p_kind, p_begin, p_length, m_line,
+               static_cast<uint32_t>(p_begin - m_line_start + 1)};
+}
+
+void HandLexer::endLines(const char *p_pos, bool p_in_comment) {
+  const char *begin = m_buffer.data();
+  const LineIndex &index = *m_line_index;
+  while (p_pos >= m_next_line_start) {
+    m_on_line(m_line, m_line_start, index.getLineLength(m_line), p_in_comment);
+    ++m_line;
+    m_line_start = m_next_line_start;
+    m_next_line_start = index.hasNewline(m_line)
+                            ? begin + index.getLineOffset(m_line + 1)
+                            : m_end + 1;
+  }
+}
+
+const char *HandLexer::skipWhitespace(const char *p_pos) {
+#if defined(__SSE2__)
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i newline = _mm_set1_epi8('\n');
+  for (;;) {
+    // The padding is not whitespace, so the loop stops at the end at last.
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_pos));
+    const __m128i is_whitespace = _mm_or_si128(
+        _mm_cmpeq_epi8(chunk, newline),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)));
+    const unsigned others = ~_mm_movemask_epi8(is_whitespace) & 0xffffu;
+    if (others) {
+      return p_pos + __builtin_ctz(others);
+    }
+    p_pos += 16;
+  }
+#else
+  while (kCharClasses[*p_pos] == kBlank) {
+    ++p_pos;
+  }
+  return p_pos;
+#endif
+}
+
+const char *HandLexer::skipBlockComment(const char *p_pos) {
+  const char *end = findPair(p_pos, m_end, '*', '/');
+  return end < m_end ? end + 2 : m_end;
+}
+
+size_t HandLexer::scanNumber(const char *p_begin, TokenKind &p_kind) const {
+  // Every rule of `scanner.l` that may match is tried; as with flex, the
+  // longest match wins, and the earlier rule on a tie.
+  const bool is_zero = *p_begin == '0';
+  const size_t integer_length = is_zero ? 1 : countDigits(p_begin);
+  p_kind = TokenKind::kIntegerLiteral;
+  size_t length = integer_length;
+
+  if (is_zero && isOctalDigit(p_begin[1])) {
+    const char *end = p_begin + 1;
+    while (isOctalDigit(*end)) {
+      ++end;
+    }
+    p_kind = TokenKind::kOctIntegerLiteral;
+    length = end - p_begin;
+  }
+
+  // The mantissa of a scientific notation has to end right before the
+  // exponent, i.e., it is the whole integer or the whole float.
+  size_t mantissa_length = is_zero ? 0 : integer_length;
+  if (p_begin[integer_length] == '.') {
+    const char *fraction = p_begin + integer_length + 1;
+    const size_t num_digits = countDigits(fraction);
+    // The fraction is `0` or ends with a nonzero digit.
+    size_t fraction_length = num_digits;
+    while (fraction_length > 0 && fraction[fraction_length - 1] == '0') {
+      --fraction_length;
+    }
+    const bool is_nonzero_fraction = fraction_length == num_digits;
+    if (fraction_length == 0 && num_digits > 0) {
+      fraction_length = 1;
+    }
+    if (fraction_length > 0 && integer_length + 1 + fraction_length > length) {
+      p_kind = TokenKind::kFloatLiteral;
+      length = integer_length + 1 + fraction_length;
+    }
+    if (num_digits > 0 &&
+        (is_nonzero_fraction || (!is_zero && fraction_length == num_digits))) {
+      mantissa_length = integer_length + 1 + num_digits;
+    }
+  }
+
+  const char *exponent = p_begin + mantissa_length;
+  if (mantissa_length > 0 && (*exponent == 'E' || *exponent == 'e')) {
+    ++exponent;
+    if (*exponent == '+' || *exponent == '-') {
+      ++exponent;
+    }
+    if (isDigit(*exponent)) {
+      const size_t exponent_length =
+          *exponent == '0' ? 1 : countDigits(exponent);
+      const size_t scientific_length = exponent + exponent_length - p_begin;
+      if (scientific_length > length) {
+        p_kind = TokenKind::kScientificLiteral;
+        length = scientific_length;
+      }
+    }
+  }
+  return length;
+}
+
+size_t HandLexer::scanString(const char *p_begin) const {
+  // A `""` continues the string; the longest string ending with a lone `"`
+  // on this line is the match.
+  const char *end = nullptr;
+  const char *pos = p_begin + 1;
+  for (;;) {
+    pos = findEither(pos, m_end, '"', '\n');
+    if (pos >= m_end || *pos == '\n') {
+      break;
+    }
+    end = pos + 1;
+    if (pos[1] != '"') {
+      break;
+    }
+    pos += 2;
+  }
+  return end ? end - p_begin : 0;
+}
+
+TokenKind HandLexer::lookUpKeyword(const char *p_text, size_t p_length) {
+  if (p_length < kMinKeywordLength || p_length > kMaxKeywordLength) {
+    return TokenKind::kIdentifier;
+  }
+  const Keyword *keyword = kKeywordTable.m_slots[hashKeyword(p_text, p_length)];
+  if (keyword && strncmp(keyword->m_text, p_text, p_length) == 0 &&
+      keyword->m_text[p_length] == '\0') {
+    return keyword->m_kind;
+  }
+  return TokenKind::kIdentifier;
+}
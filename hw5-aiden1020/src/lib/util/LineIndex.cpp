@@ -0,0 +1,51 @@
+#include "util/LineIndex.hpp"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+LineIndex::LineIndex(const char *p_text, size_t p_size) : m_size{p_size} {
+  m_line_offsets.push_back(0);
+
+  size_t offset = 0;
+#if defined(__AVX2__)
+  const __m256i newline = _mm256_set1_epi8('\n');
+  for (; offset + 32 <= p_size; offset += 32) {
+    const __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p_text + offset));
+    auto newlines = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+    while (newlines) {
+      m_line_offsets.push_back(offset + __builtin_ctz(newlines) + 1);
+      newlines &= newlines - 1;
+    }
+  }
+#elif defined(__SSE2__)
+  const __m128i newline = _mm_set1_epi8('\n');
+  for (; offset + 16 <= p_size; offset += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_text + offset));
+    auto newlines = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+    while (newlines) {
+      m_line_offsets.push_back(offset + __builtin_ctz(newlines) + 1);
+      newlines &= newlines - 1;
+    }
+  }
+#endif
+
+  // The tail shorter than a vector, or the whole text without SIMD.
+  while (offset < p_size) {
+    const auto *found = static_cast<const char *>(
+        memchr(p_text + offset, '\n', p_size - offset));
+    if (found == nullptr) {
+      break;
+    }
+    offset = found - p_text + 1;
+    m_line_offsets.push_back(offset);
+  }
+}
@@ -20,17 +20,29 @@
 #include "AST/while.hpp"
 
 #include "codegen/CodeGenerator.hpp"
+#include "sema/CheckedModule.hpp"
+#include "sema/DiagnosticEngine.hpp"
+#include "sema/ErrorPrinter.hpp"
+#include "sema/InterfaceFile.hpp"
+#include "sema/NameResolver.hpp"
 #include "sema/SemanticAnalyzer.hpp"
 
 #include "AST/constant.hpp"
 #include "AST/operator.hpp"
 
 #include "AST/AstDumper.hpp"
+#include "util/CompileServer.hpp"
 
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #define YYLTYPE yyltype
 
@@ -44,14 +56,20 @@ typedef struct YYLTYPE {
 extern int32_t line_num;    /* declared in scanner.l */
 extern char current_line[]; /* declared in scanner.l */
 extern uint32_t opt_dmp;    /* declared in scanner.l */
+extern bool use_hand_lexer; /* declared in scanner.l */
+extern uint32_t num_lexical_errors; /* declared in scanner.l */
 extern FILE *yyin;          /* declared by lex */
 extern char *yytext;        /* declared by lex */
 
 static AstNode *root;
+static uint32_t num_syntax_errors = 0;
+/* Set while compiling; syntax errors go through it in the machine formats. */
+static DiagnosticEngine *diagnostics = nullptr;
 
 extern "C" int yylex(void);
 static void yyerror(const char *msg);
 extern int yylex_destroy(void);
+extern void updateErrorContext(void); /* declared in scanner.l */
 %}
 
 // This guarantees that headers do not conflict when included together.
@@ -121,6 +139,13 @@ extern int yylex_destroy(void);
 %type <nodes_ptr> StatementList Statements
 %type <exprs_ptr> ExpressionList Expressions ArrRefList ArrRefs
 
+    /* Values discarded while recovering from a syntax error */
+%destructor { free($$); } <identifier> <string>
+%destructor { delete $$; } <node> <type_ptr> <decl_ptr> <compound_stmt_ptr>
+%destructor { delete $$; } <constant_value_node_ptr> <func_ptr> <expr_ptr>
+%destructor { delete $$; } <decls_ptr> <ids_ptr> <dimensions_ptr> <funcs_ptr>
+%destructor { delete $$; } <nodes_ptr> <exprs_ptr>
+
     /* Follow the order in scanner.l */
 
     /* Delimiter */
@@ -184,14 +209,20 @@ DeclarationList:
     Declarations
 ;
 
+    /* A declaration, function or statement with a syntax error is null and
+       left out of its list. */
 Declarations:
     Declaration {
         $$ = new std::vector<std::unique_ptr<DeclNode>>();
-        $$->emplace_back($1);
+        if ($1) {
+            $$->emplace_back($1);
+        }
     }
     |
     Declarations Declaration {
-        $1->emplace_back($2);
+        if ($2) {
+            $1->emplace_back($2);
+        }
         $$ = $1;
     }
 ;
@@ -207,11 +238,15 @@ FunctionList:
 Functions:
     Function {
         $$ = new std::vector<std::unique_ptr<FunctionNode>>();
-        $$->emplace_back($1);
+        if ($1) {
+            $$->emplace_back($1);
+        }
     }
     |
     Functions Function {
-        $1->emplace_back($2);
+        if ($2) {
+            $1->emplace_back($2);
+        }
         $$ = $1;
     }
 ;
@@ -228,6 +263,17 @@ FunctionDeclaration:
         free($1);
         delete $3;
     }
+    |
+    /* The function is still declared, with the error type and without
+       parameters, so that its calls are not reported as undeclared. */
+    FunctionName L_PARENTHESIS error R_PARENTHESIS ReturnType SEMICOLON {
+        FunctionNode::DeclNodes parameters;
+        $$ = new FunctionNode(@1.first_line, @1.first_column, $1, parameters,
+                              new PType(PType::PrimitiveTypeEnum::kErrorType),
+                              nullptr);
+        free($1);
+        delete $5;
+    }
 ;
 
 FunctionDefinition:
@@ -238,6 +284,20 @@ FunctionDefinition:
         free($1);
         delete $3;
     }
+    |
+    /* Declared like the above. The body is parsed for its syntax errors,
+       but it is not checked without the parameters. */
+    FunctionName L_PARENTHESIS error R_PARENTHESIS ReturnType
+    CompoundStatement
+    END {
+        FunctionNode::DeclNodes parameters;
+        $$ = new FunctionNode(@1.first_line, @1.first_column, $1, parameters,
+                              new PType(PType::PrimitiveTypeEnum::kErrorType),
+                              nullptr);
+        free($1);
+        delete $5;
+        delete $6;
+    }
 ;
 
 FunctionName:
@@ -309,6 +369,24 @@ Declaration:
         $$ = new DeclNode(@1.first_line, @1.first_column, $2, $4);
         delete $2;
     }
+    |
+    /* The ids read before the error are still declared, with the error
+       type, so that their uses are not reported as undeclared. */
+    VAR IdList COLON error SEMICOLON {
+        $$ = new DeclNode(@1.first_line, @1.first_column, $2,
+                          new PType(PType::PrimitiveTypeEnum::kErrorType));
+        delete $2;
+    }
+    |
+    VAR IdList error SEMICOLON {
+        $$ = new DeclNode(@1.first_line, @1.first_column, $2,
+                          new PType(PType::PrimitiveTypeEnum::kErrorType));
+        delete $2;
+    }
+    |
+    VAR error SEMICOLON {
+        $$ = nullptr;
+    }
 ;
 
 Type:
@@ -461,6 +539,10 @@ Statement:
     Return
     |
     FunctionCall
+    |
+    error SEMICOLON {
+        $$ = nullptr;
+    }
 ;
 
 CompoundStatement:
@@ -526,6 +608,22 @@ Condition:
     END IF {
         $$ = new IfNode(@1.first_line, @1.first_column, $2, $4, $5);
     }
+    |
+    /* Only the bodies are kept, in a compound statement of their own, so
+       that they are still checked. */
+    IF error THEN
+    CompoundStatement
+    ElseOrNot
+    END IF {
+        CompoundStatementNode::DeclNodes decls;
+        CompoundStatementNode::StmtNodes bodies;
+        bodies.emplace_back($4);
+        if ($5) {
+            bodies.emplace_back($5);
+        }
+        $$ = new CompoundStatementNode(@1.first_line, @1.first_column, decls,
+                                       bodies);
+    }
 ;
 
 ElseOrNot:
@@ -545,6 +643,12 @@ While:
     END DO {
         $$ = new WhileNode(@1.first_line, @1.first_column, $2, $4);
     }
+    |
+    WHILE error DO
+    CompoundStatement
+    END DO {
+        $$ = $4;
+    }
 ;
 
 For:
@@ -639,11 +743,15 @@ StatementList:
 Statements:
     Statement {
         $$ = new std::vector<std::unique_ptr<AstNode>>();
-        $$->emplace_back($1);
+        if ($1) {
+            $$->emplace_back($1);
+        }
     }
     |
     Statements Statement {
-        $1->emplace_back($2);
+        if ($2) {
+            $1->emplace_back($2);
+        }
         $$ = $1;
     }
 ;
@@ -747,7 +855,18 @@ Epsilon:
 
 %%
 
+/// @note The parser goes on after the error; see the `error` rules.
 void yyerror(const char *msg) {
+    updateErrorContext();
+    ++num_syntax_errors;
+    if (diagnostics &&
+        diagnostics->getPrinter().getFormat() != ErrorPrinter::Format::kText) {
+        diagnostics->report("syntax-error",
+                            Location(yylloc.first_line, yylloc.first_column),
+                            std::string(msg) + ", unmatched token '" + yytext +
+                                "'");
+        return;
+    }
     fprintf(stderr,
             "\n"
             "|-----------------------------------------------------------------"
@@ -758,35 +877,290 @@ void yyerror(const char *msg) {
             "|-----------------------------------------------------------------"
             "---------\n",
             line_num, current_line, yytext);
-    exit(-1);
 }
 
-int main(int argc, const char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Usage: %s <filename> --save-path [save path]\n", argv[0]);
-        exit(-1);
+namespace {
+/// @brief Code generated from the same parse as the main output, e.g., for
+/// another target or with other settings.
+struct BackEndVariant {
+    std::string save_path;
+    bool gc_functions = false;
+    bool no_main = false;
+};
+
+struct CompileOptions {
+    bool dump_ast = false;
+    bool report_inline = false;
+    bool gc_functions = false;
+    std::string save_path;
+    std::string cache_dir;
+    bool no_main = false;
+    std::string emit_interface;
+    std::vector<std::string> imports;
+    std::string emit_module;
+    bool load_module = false;
+    std::string prelude;
+    bool hand_lexer = false;
+    bool lex_only = false;
+    ErrorPrinter::Format diagnostics_format = ErrorPrinter::Format::kText;
+    uint32_t error_limit = 0;
+    std::vector<BackEndVariant> variants;
+};
+} // namespace
+
+/// @brief Parses `<save path>[:<flag>[,<flag>]...]`, where a flag is
+/// `gc-functions` or `no-main`.
+static BackEndVariant parseVariant(const std::string &p_spec) {
+    BackEndVariant variant;
+    const size_t colon = p_spec.rfind(':');
+    variant.save_path = p_spec.substr(0, colon);
+    if (colon == std::string::npos) {
+        return variant;
+    }
+    for (size_t begin = colon + 1; begin <= p_spec.size();) {
+        size_t end = p_spec.find(',', begin);
+        if (end == std::string::npos) {
+            end = p_spec.size();
+        }
+        const std::string flag = p_spec.substr(begin, end - begin);
+        if (flag == "gc-functions") {
+            variant.gc_functions = true;
+        } else if (flag == "no-main") {
+            variant.no_main = true;
+        } else {
+            fprintf(stderr, "Unknown flag '%s' in --variant %s\n", flag.c_str(),
+                    p_spec.c_str());
+            exit(-1);
+        }
+        begin = end + 1;
+    }
+    return variant;
+}
+
+static CompileOptions parseOptions(const std::vector<std::string> &p_args) {
+    CompileOptions options;
+    for (size_t i = 0; i < p_args.size(); ++i) {
+        if (p_args[i] == "--dump-ast") {
+            options.dump_ast = true;
+        } else if (p_args[i] == "--report-inline") {
+            options.report_inline = true;
+        } else if (p_args[i] == "--gc-functions") {
+            options.gc_functions = true;
+        } else if (p_args[i] == "--cache-dir" && i + 1 < p_args.size()) {
+            options.cache_dir = p_args[++i];
+        } else if (p_args[i] == "--no-main") {
+            options.no_main = true;
+        } else if (p_args[i] == "--emit-interface" && i + 1 < p_args.size()) {
+            options.emit_interface = p_args[++i];
+        } else if (p_args[i] == "--import" && i + 1 < p_args.size()) {
+            options.imports.push_back(p_args[++i]);
+        } else if (p_args[i] == "--emit-module" && i + 1 < p_args.size()) {
+            options.emit_module = p_args[++i];
+        } else if (p_args[i] == "--load-module") {
+            options.load_module = true;
+        } else if (p_args[i] == "--prelude" && i + 1 < p_args.size()) {
+            options.prelude = p_args[++i];
+        } else if (p_args[i] == "--lexer" && i + 1 < p_args.size()) {
+            options.hand_lexer = p_args[++i] == "hand";
+        } else if (p_args[i] == "--lex-only") {
+            options.lex_only = true;
+        } else if (p_args[i] == "--diagnostics-format=json") {
+            options.diagnostics_format = ErrorPrinter::Format::kJson;
+        } else if (p_args[i] == "--diagnostics-format=sarif") {
+            options.diagnostics_format = ErrorPrinter::Format::kSarif;
+        } else if (p_args[i] == "--diagnostics-format=text") {
+            options.diagnostics_format = ErrorPrinter::Format::kText;
+        } else if (p_args[i] == "--variant" && i + 1 < p_args.size()) {
+            options.variants.push_back(parseVariant(p_args[++i]));
+        } else if (p_args[i].compare(0, 14, "-ferror-limit=") == 0) {
+            options.error_limit = static_cast<uint32_t>(
+                strtoul(p_args[i].c_str() + 14, nullptr, 10));
+        } else if (i + 1 < p_args.size()) {
+            // --save-path (or --save_path) followed by the directory
+            options.save_path = p_args[++i];
+        }
+    }
+    return options;
+}
+
+static void generateVariant(AstNode &p_root, const std::string &p_source_path,
+                            const CheckedModule::SymbolTables &p_symbol_tables,
+                            const BackEndVariant &p_variant,
+                            const ProgramNode *p_prelude) {
+    CodeGenerator code_generator(p_source_path, p_variant.save_path,
+                                 p_symbol_tables);
+    if (p_prelude) {
+        code_generator.setPrelude(*p_prelude);
+    }
+    code_generator.setGcFunctions(p_variant.gc_functions);
+    code_generator.setEmitsMain(!p_variant.no_main);
+    p_root.accept(code_generator);
+}
+
+/// @brief Resolves the names and generates the main output and, on threads
+/// of their own, the variants. The code generators share the AST, with its
+/// resolved names, and the symbol tables, which they only read.
+static void generateCode(AstNode &p_root, const std::string &p_source_path,
+                         const CheckedModule::SymbolTables &p_symbol_tables,
+                         const CompileOptions &p_options,
+                         const ProgramNode *p_prelude = nullptr) {
+    NameResolver name_resolver(p_symbol_tables);
+    p_root.accept(name_resolver);
+
+    std::vector<std::thread> variant_threads;
+    for (const auto &variant : p_options.variants) {
+        variant_threads.emplace_back(generateVariant, std::ref(p_root),
+                                     std::cref(p_source_path),
+                                     std::cref(p_symbol_tables),
+                                     std::cref(variant), p_prelude);
     }
 
-    yyin = fopen(argv[1], "r");
-    if (yyin == NULL) {
-        perror("fopen() failed");
+    CodeGenerator code_generator(p_source_path, p_options.save_path,
+                                 p_symbol_tables);
+    if (p_prelude) {
+        code_generator.setPrelude(*p_prelude);
+    }
+    code_generator.setReportInlining(p_options.report_inline);
+    code_generator.setGcFunctions(p_options.gc_functions);
+    code_generator.setEmitsMain(!p_options.no_main);
+    if (!p_options.cache_dir.empty()) {
+        code_generator.setFunctionCacheDirectory(p_options.cache_dir);
+    }
+    p_root.accept(code_generator);
+
+    for (auto &thread : variant_threads) {
+        thread.join();
+    }
+}
+
+/// @brief Generates code for a module saved by `--emit-module`, which has
+/// been checked already.
+static int compileModule(const char *p_module_path,
+                         const CompileOptions &p_options) {
+    auto module = CheckedModule::read(p_module_path);
+    if (!module) {
         exit(-1);
     }
+    if (p_options.dump_ast) {
+        AstDumper ast_dumper;
+        module->getProgram().accept(ast_dumper);
+    }
+    generateCode(module->getProgram(), module->getSourcePath(),
+                 module->acquireSymbolTableOfScopingNodes(), p_options);
+    return 0;
+}
+
+/// @brief Runs the lexer alone to the end of the source and reports the time
+/// it takes, so that the two lexers can be compared.
+static int lex() {
+    const auto start = std::chrono::steady_clock::now();
+    size_t num_tokens = 0;
+    for (int token; (token = yylex()) != 0; ++num_tokens) {
+        if (token == TOK_ID) {
+            free(yylval.identifier);
+        } else if (token == TOK_STRING_LITERAL) {
+            free(yylval.string);
+        }
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    fprintf(stderr, "%s lexer: %zu tokens in %.3f ms\n",
+            use_hand_lexer ? "hand" : "flex", num_tokens, elapsed / 1000.0);
 
+    fclose(yyin);
+    yylex_destroy();
+    return 0;
+}
+
+static int compile(const char *p_source_path, FILE *p_source,
+                   const CompileOptions &p_options) {
+    yyin = p_source;
+    use_hand_lexer = p_options.hand_lexer;
+    if (p_options.lex_only) {
+        return lex();
+    }
+    const ErrorPrinter printer(stderr, p_options.diagnostics_format,
+                               p_source_path);
+    DiagnosticEngine engine(printer, p_options.error_limit);
+    diagnostics = &engine;
     yyparse();
+    // The AST is partial if there is any syntax error; it is still checked
+    // so that one run reports as many errors as possible, but no code is
+    // generated from it.
+    const bool has_syntax_error = num_syntax_errors > 0 || num_lexical_errors > 0;
+    if (root == nullptr) {
+        engine.flush();
+        exit(-1);
+    }
 
-    if (argc >= 3 && strcmp(argv[2], "--dump-ast") == 0) {
+    if (p_options.dump_ast) {
         AstDumper ast_dumper;
         root->accept(ast_dumper);
     }
 
-    SemanticAnalyzer sema_analyzer(opt_dmp);
+    // The interfaces are kept until the code is generated, since the symbol
+    // tables refer to them.
+    std::vector<std::unique_ptr<InterfaceFile>> imports;
+    SemanticAnalyzer sema_analyzer(opt_dmp, engine);
+    // A prelude is a module saved by `--emit-module` that only declares.
+    std::unique_ptr<CheckedModule> prelude;
+    if (!p_options.prelude.empty()) {
+        prelude = CheckedModule::read(p_options.prelude);
+        if (!prelude) {
+            exit(-1);
+        }
+        if (!prelude->isPrelude()) {
+            fprintf(stderr, "%s: a prelude can only declare globals and functions\n",
+                    p_options.prelude.c_str());
+            exit(-1);
+        }
+        sema_analyzer.setPrelude(prelude->getGlobalSymbolTable());
+    }
+    for (const auto &path : p_options.imports) {
+        imports.push_back(InterfaceFile::read(path));
+        if (!imports.back()) {
+            exit(-1);
+        }
+        sema_analyzer.addImport(*imports.back());
+    }
     root->accept(sema_analyzer);
+    engine.flush();
+    if (has_syntax_error) {
+        exit(-1);
+    }
+
+    if (!p_options.emit_interface.empty() && !sema_analyzer.hasError()) {
+        FILE *interface = fopen(p_options.emit_interface.c_str(), "w");
+        if (interface == NULL) {
+            perror("Failed to open the interface");
+            exit(-1);
+        }
+        InterfaceFile::write(static_cast<const ProgramNode &>(*root), interface);
+        fclose(interface);
+    }
 
-    CodeGenerator code_generator(
-        argv[1], (argc == 4) ? argv[3] : "",
-        std::move(sema_analyzer.acquireSymbolTableOfScopingNodes()));
-    root->accept(code_generator);
+    // Frozen from here on; the code generators share the tables.
+    const auto symbol_tables =
+        std::move(sema_analyzer.acquireSymbolTableOfScopingNodes());
+    if (!p_options.emit_module.empty() && prelude) {
+        fprintf(stderr, "--emit-module cannot be used with --prelude\n");
+        exit(-1);
+    }
+    if (!p_options.emit_module.empty() && !sema_analyzer.hasError()) {
+        std::vector<const InterfaceFile *> interfaces;
+        for (const auto &interface : imports) {
+            interfaces.push_back(interface.get());
+        }
+        if (!CheckedModule::write(p_options.emit_module, p_source_path,
+                                  static_cast<const ProgramNode &>(*root),
+                                  interfaces, symbol_tables)) {
+            exit(-1);
+        }
+    }
+
+    generateCode(*root, p_source_path, symbol_tables, p_options,
+                 prelude ? &prelude->getProgram() : nullptr);
 
     if (!sema_analyzer.hasError()) {
         printf("\n"
@@ -800,3 +1174,64 @@ int main(int argc, const char *argv[]) {
     yylex_destroy();
     return 0;
 }
+
+/// @brief Compiles a request of the `--server` mode in the forked child.
+static int compileRequest(const CompileRequest &p_request) {
+    std::vector<std::string> args = p_request.m_flags;
+    if (!p_request.m_save_path.empty()) {
+        args.push_back("--save-path");
+        args.push_back(p_request.m_save_path);
+    }
+    const CompileOptions options = parseOptions(args);
+    if (options.load_module && !p_request.m_has_source_text) {
+        return compileModule(p_request.m_source_path.c_str(), options);
+    }
+
+    FILE *source =
+        p_request.m_has_source_text
+            ? fmemopen(const_cast<char *>(p_request.m_source_text.data()),
+                       p_request.m_source_text.size(), "r")
+            : fopen(p_request.m_source_path.c_str(), "r");
+    if (source == NULL) {
+        perror("Failed to open the source");
+        return -1;
+    }
+    return compile(p_request.m_source_path.c_str(), source, options);
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc < 2 || (strcmp(argv[1], "--server") == 0 && argc < 3)) {
+        fprintf(stderr,
+                "Usage: %s <filename> [--dump-ast] [--report-inline] "
+                "[--gc-functions] [--cache-dir <dir>]\n"
+                "       [--no-main] [--emit-interface <file>] [--import <file>]... "
+                "[--emit-module <file>] [--prelude <module>]\n"
+                "       [--lexer <flex|hand>] [--lex-only] "
+                "[--diagnostics-format=<text|json|sarif>]\n"
+                "       [-ferror-limit=<n>] "
+                "[--variant <save path>[:gc-functions,no-main]]...\n"
+                "       --save-path [save path]\n"
+                "       %s <module> --load-module [--save-path [save path]]\n"
+                "       %s --server <socket path>\n",
+                argv[0], argv[0], argv[0]);
+        exit(-1);
+    }
+
+    if (strcmp(argv[1], "--server") == 0) {
+        CompileServer server(argv[2], compileRequest);
+        return server.run();
+    }
+
+    const CompileOptions options =
+        parseOptions(std::vector<std::string>(argv + 2, argv + argc));
+    if (options.load_module) {
+        return compileModule(argv[1], options);
+    }
+
+    FILE *source = fopen(argv[1], "r");
+    if (source == NULL) {
+        perror("fopen() failed");
+        exit(-1);
+    }
+    return compile(argv[1], source, options);
+}
@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 void printInt(int value)
 {
@@ -27,3 +29,28 @@ void printString(char *value)
 {
     printf("%s\n", value);
 }
+
+// Strings are never freed, so the results of concatenation are carved out of
+// a static arena; only the ones that do not fit anymore go to the heap.
+static char string_arena[1 << 16];
+static size_t string_arena_used = 0;
+
+char *concatString(char *left, char *right)
+{
+    size_t left_length = strlen(left);
+    size_t right_length = strlen(right);
+    size_t size = left_length + right_length + 1;
+    char *result;
+    if (size <= sizeof(string_arena) - string_arena_used)
+    {
+        result = string_arena + string_arena_used;
+        string_arena_used += size;
+    }
+    else
+    {
+        result = malloc(size);
+    }
+    memcpy(result, left, left_length);
+    memcpy(result + left_length, right, right_length + 1);
+    return result;
+}
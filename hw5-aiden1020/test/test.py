@@ -2,12 +2,17 @@
 
 import argparse
 import colorama
+import difflib
+import re
+import socket
 import subprocess
 import sys
+import tempfile
+import time
 from dataclasses import dataclass
 from enum import Enum, auto
 from pathlib import Path
-from typing import Dict, List
+from typing import Dict, List, Tuple
 
 DIR = Path(__file__).resolve().parent
 
@@ -29,15 +34,46 @@ class TestCase:
     type: CaseType
     score: float
     name: str
+    # Passed to the compiler; paths are relative to this directory.
+    flags: Tuple[str, ...] = ()
+    # Generates the code from the module saved by "--emit-module" rather than
+    # from the source.
+    through_module: bool = False
+    # The name of a program in "test_cases" that only declares, whose module
+    # is passed by "--prelude".
+    prelude: str = ""
+    # The name of a program in "test_cases" compiled by "--no-main" with the
+    # flags of the case, whose interface is imported and whose code is linked.
+    library: str = ""
+    # Compares the messages of the compiler instead of the output of the
+    # program; the flags are relative to "test_cases" then.
+    diagnostics: bool = False
+    # Compiles the case by a request to the "--server" mode, right after
+    # requests that are malformed, which the server has to survive.
+    server: bool = False
+    # Also compiles every case in "test_cases" with "--lexer hand", which has
+    # to agree with the flex lexer on the messages and the code.
+    lexers: bool = False
+    # Lists the functions defined in the code before the output of the program,
+    # so that the solution shows which ones are left out.
+    functions: bool = False
 
 
 class Grader:
     """
-    case_id: TestCase(case_type, score, case_name)
-        case_id     Used by the "--case_id" flag to run only one test case
-        case_type   The diff of CaseType.HIDDEN is not shown
-        score       The max score of the test case
-        case_name   The name of the file in "test_cases" and "sample_solutions"
+    case_id: TestCase(case_type, score, case_name[, flags[, through_module[, prelude[, library[, diagnostics[, server[, lexers[, functions]]]]]]]])
+        case_id         Used by the "--case_id" flag to run only one test case
+        case_type       The diff of CaseType.HIDDEN is not shown
+        score           The max score of the test case
+        case_name       The name of the file in "test_cases" and "sample_solutions"
+        flags           The extra options of the compiler
+        through_module  Whether the code is generated from the saved module
+        prelude         The program whose declarations the case is compiled with
+        library         The program compiled separately and linked with the case
+        diagnostics     Whether the solution is the messages of the compiler
+        server          Whether the case is compiled by the compile server
+        lexers          Whether the hand-written lexer is checked against flex
+        functions       Whether the functions in the code are part of the result
     """
     CASES: Dict[str, TestCase] = {
         "1": TestCase(CaseType.OPEN, 5.0, "01_variable_constant"),
@@ -80,6 +116,33 @@ class Grader:
         "h18": TestCase(CaseType.HIDDEN, 1.5, "h18_bonus_string"),
         "h19": TestCase(CaseType.HIDDEN, 1.5, "h19_bonus_real_1"),
         "h20": TestCase(CaseType.HIDDEN, 1.5, "h20_bonus_real_2"),
+        # Cases of the optimizations and features beyond the assignment, which
+        # are worth no points.
+        "21": TestCase(CaseType.OPEN, 0.0, "21_inline_leaf"),
+        "22": TestCase(CaseType.OPEN, 0.0, "22_tail_call"),
+        "23": TestCase(CaseType.OPEN, 0.0, "23_common_subexpressions"),
+        "24": TestCase(CaseType.OPEN, 0.0, "24_short_circuit"),
+        # The second case edits a function of the first one, which must not
+        # hit the entry cached for it.
+        "25": TestCase(CaseType.OPEN, 0.0, "25_function_cache", ("--cache-dir", "function_cache")),
+        "26": TestCase(CaseType.OPEN, 0.0, "26_function_cache_edited", ("--cache-dir", "function_cache")),
+        "27": TestCase(CaseType.OPEN, 0.0, "27_checked_module", through_module=True),
+        "28": TestCase(CaseType.OPEN, 0.0, "28_prelude", prelude="28_prelude_declarations"),
+        # The solutions of the following cases are the messages of the compiler.
+        "29": TestCase(CaseType.OPEN, 0.0, "29_error_recovery", diagnostics=True),
+        "30": TestCase(CaseType.OPEN, 0.0, "30_diagnostics_json", ("--diagnostics-format=json",), diagnostics=True),
+        "31": TestCase(CaseType.OPEN, 0.0, "31_diagnostics_sarif", ("--diagnostics-format=sarif",), diagnostics=True),
+        "32": TestCase(CaseType.OPEN, 0.0, "32_error_limit", ("-ferror-limit=3",), diagnostics=True),
+        "33": TestCase(CaseType.OPEN, 0.0, "33_error_dedup", diagnostics=True),
+        "34": TestCase(CaseType.OPEN, 0.0, "34_compile_server", server=True),
+        "35": TestCase(CaseType.OPEN, 0.0, "35_error_limit_json", ("--diagnostics-format=json", "-ferror-limit=2"), diagnostics=True),
+        "36": TestCase(CaseType.OPEN, 0.0, "36_error_limit_sarif", ("--diagnostics-format=sarif", "-ferror-limit=2"), diagnostics=True),
+        "37": TestCase(CaseType.OPEN, 0.0, "37_lexer_agreement", diagnostics=True, lexers=True),
+        # The solutions of the following cases are the output of the program
+        # again.
+        "38": TestCase(CaseType.OPEN, 0.0, "38_separate_compilation", ("--gc-functions",), library="38_separate_compilation_library"),
+        "39": TestCase(CaseType.OPEN, 0.0, "39_gc_functions", ("--gc-functions",), functions=True),
+        "40": TestCase(CaseType.OPEN, 0.0, "40_loop_invariants"),
         # Uncomment next line to add a new test case:
         # "my1": TestCase(CaseType.OPEN, 0.0, "my_test_case_1"),
     }
@@ -95,6 +158,7 @@ class Grader:
         self.assembler_output_dir: Path = DIR / "assembler_output"
         self.executable_dir: Path = DIR / "executable"
         self.asm_dir: Path = DIR / "riscv"
+        self.module_dir: Path = DIR / "module"
         self.output_dir: Path = DIR / "result"
         if not self.compiler_output_dir.exists():
             self.compiler_output_dir.mkdir()
@@ -104,6 +168,8 @@ class Grader:
             self.executable_dir.mkdir()
         if not self.asm_dir.exists():
             self.asm_dir.mkdir()
+        if not self.module_dir.exists():
+            self.module_dir.mkdir()
         if not self.output_dir.exists():
             self.output_dir.mkdir()
 
@@ -131,10 +197,10 @@ class Grader:
             print(f"ERROR: Invalid case ID {input_case_id}")
             exit(1)
 
-    def execute_process(self, command: List[str], stdin: bytes = b"") -> tuple[int, bytes, bytes]:
+    def execute_process(self, command: List[str], stdin: bytes = b"", cwd: Path = DIR) -> tuple[int, bytes, bytes]:
         """Returns the exit code, stdout, and stderr of the process."""
         try:
-            process = subprocess.Popen(command, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+            process = subprocess.Popen(command, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.PIPE, cwd=cwd)
             assert process.stdin is not None
             process.stdin.write(stdin)
             process.stdin.close()
@@ -148,6 +214,70 @@ class Grader:
         stderr: bytes = process.stderr.read()
         return exit_code, stdout, stderr
 
+    # Each is answered with an error, without taking the server down.
+    MALFORMED_REQUESTS: List[bytes] = [
+        b"text huge.p 99999999999999999999999\n\n",
+        b"text large.p 1000000000000\n\n",
+        b"text nosize.p\n\n",
+        b"unknown request\n\n",
+    ]
+
+    def send_request(self, socket_path: str, request: bytes) -> bytes:
+        """Returns everything the server sends back until it hangs up."""
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as client:
+            client.connect(socket_path)
+            client.sendall(request)
+            response: bytes = b""
+            while chunk := client.recv(4096):
+                response += chunk
+        return response
+
+    def compile_through_server(self, case_path: Path, flags: Tuple[str, ...]) -> tuple[bytes, bytes]:
+        """Returns the response to the request of the case, and the complaints about the malformed requests."""
+        with tempfile.TemporaryDirectory() as socket_dir:
+            socket_path: str = str(Path(socket_dir) / "server.sock")
+            server = subprocess.Popen([str(self.executable), "--server", socket_path], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, cwd=DIR)
+            try:
+                for _ in range(100):
+                    if Path(socket_path).exists() or server.poll() is not None:
+                        break
+                    time.sleep(0.05)
+                complaints: bytes = b""
+                for request in self.MALFORMED_REQUESTS:
+                    response: bytes = self.send_request(socket_path, request)
+                    if response != b"error malformed request\n":
+                        complaints += b"Unexpected response to " + request + b": " + response + b"\n"
+                source: bytes = case_path.read_bytes()
+                request = f"text {case_path} {len(source)}\n".encode() + source
+                request += f"save-path {self.asm_dir}\n".encode()
+                if flags:
+                    request += f"flag {' '.join(flags)}\n".encode()
+                return self.send_request(socket_path, request + b"\n"), complaints
+            except OSError as e:
+                return b"", f"The server failed: {e}\n".encode()
+            finally:
+                server.kill()
+                server.wait()
+
+    def compile_with_lexer(self, case_path: Path, lexer: str, save_path: str) -> str:
+        """Returns the messages of the compiler followed by the code it generates."""
+        _, stdout, stderr = self.execute_process([str(self.executable), case_path.name, "--lexer", lexer, "--save-path", save_path], cwd=self.case_dir)
+        asm_path: Path = Path(save_path) / f"{case_path.stem}.S"
+        code: bytes = asm_path.read_bytes() if asm_path.exists() else b""
+        return (stdout + stderr + b"--- code ---\n" + code).decode("utf-8", errors="replace")
+
+    def compare_lexers(self) -> bytes:
+        """Returns the diff of each case that the two lexers compile differently."""
+        disagreements: str = ""
+        with tempfile.TemporaryDirectory() as flex_dir, tempfile.TemporaryDirectory() as hand_dir:
+            for case_path in sorted(self.case_dir.glob("*.p")):
+                flex_result: str = self.compile_with_lexer(case_path, "flex", flex_dir)
+                hand_result: str = self.compile_with_lexer(case_path, "hand", hand_dir)
+                if flex_result != hand_result:
+                    disagreements += f"The lexers disagree on {case_path.name}:\n"
+                    disagreements += "".join(difflib.unified_diff(flex_result.splitlines(keepends=True), hand_result.splitlines(keepends=True), "flex", "hand"))
+        return disagreements.encode()
+
     def run_test_case(self, case: TestCase) -> TestStatus:
         """Runs the test case and outputs the diff between the result and the solution."""
         case_path: Path = self.case_dir / f"{case.name}.p"
@@ -162,16 +292,52 @@ class Grader:
             return TestStatus.SKIP
 
         # Compile to risc-v
-        compile_command: List[str] = [str(self.executable), str(case_path), "--save-path", str(self.asm_dir)]
+        flags: Tuple[str, ...] = case.flags
+        if case.prelude:
+            prelude_path: Path = self.module_dir / f"{case.prelude}.pm"
+            self.execute_process([str(self.executable), str(self.case_dir / f"{case.prelude}.p"), "--emit-module", str(prelude_path), "--save-path", str(self.module_dir)])
+            flags += ("--prelude", str(prelude_path))
+        library_asm_paths: List[str] = []
+        if case.library:
+            interface_path: Path = self.module_dir / f"{case.library}.pi"
+            self.execute_process([str(self.executable), str(self.case_dir / f"{case.library}.p"), *flags, "--no-main", "--emit-interface", str(interface_path), "--save-path", str(self.asm_dir)])
+            flags += ("--import", str(interface_path))
+            library_asm_paths.append(str(self.asm_dir / f"{case.library}.S"))
+        compile_command: List[str] = [str(self.executable), str(case_path), *flags, "--save-path", str(self.asm_dir)]
+        if case.through_module:
+            # The assembly of the first run is left out of the way, so that
+            # only the one generated from the module is assembled.
+            module_path: Path = self.module_dir / f"{case.name}.pm"
+            self.execute_process([str(self.executable), str(case_path), *flags, "--emit-module", str(module_path), "--save-path", str(self.module_dir)])
+            compile_command = [str(self.executable), str(module_path), "--load-module", "--save-path", str(self.asm_dir)]
+        if case.diagnostics:
+            # Compiled in "test_cases" by the name of the case, so that the
+            # paths in the messages do not depend on where the repository is.
+            compile_command = [str(self.executable), case_path.name, *flags, "--save-path", str(self.asm_dir)]
         compile_stdout: bytes
         compile_stderr: bytes
-        _, compile_stdout, compile_stderr = self.execute_process(compile_command)
+        if case.server:
+            compile_stdout, compile_stderr = self.compile_through_server(case_path, flags)
+        else:
+            _, compile_stdout, compile_stderr = self.execute_process(compile_command, cwd=self.case_dir if case.diagnostics else DIR)
         with compiler_output_path.open("wb") as file:
             file.write(compile_stdout)
             file.write(compile_stderr)
+        if case.server and compile_stderr:
+            # The server mishandled a request; the complaints fail the case.
+            with output_path.open("wb") as file:
+                file.write(compile_stderr)
+            return self.diff_output(case, output_path, solution_path)
+        if case.diagnostics:
+            with output_path.open("wb") as file:
+                file.write(compile_stdout)
+                file.write(compile_stderr)
+                if case.lexers:
+                    file.write(self.compare_lexers())
+            return self.diff_output(case, output_path, solution_path)
 
         # Assemble to executable
-        assemble_command: List[str] = ["riscv32-unknown-elf-gcc", str(asm_path), str(self.io_file_path), "-o", str(executable_path)]
+        assemble_command: List[str] = ["riscv32-unknown-elf-gcc", str(asm_path), *library_asm_paths, str(self.io_file_path), "-o", str(executable_path)]
         assemble_stdout: bytes
         assemble_stderr: bytes
         _, assemble_stdout, assemble_stderr = self.execute_process(assemble_command)
@@ -185,10 +351,17 @@ class Grader:
         run_stderr: bytes
         _, run_stdout, run_stderr = self.execute_process(run_command, b"123")
         with output_path.open("wb") as file:
+            if case.functions:
+                asm: str = asm_path.read_text() if asm_path.exists() else ""
+                for name in re.findall(r"^\s*\.type (\w+), @function$", asm, re.MULTILINE):
+                    file.write(f"function {name}\n".encode())
             file.write(run_stdout)
             file.write(run_stderr)
 
-        # Diff
+        return self.diff_output(case, output_path, solution_path)
+
+    def diff_output(self, case: TestCase, output_path: Path, solution_path: Path) -> TestStatus:
+        """Outputs the diff between the result and the solution."""
         diff_command: List[str] = ["diff", "-Z", "-u", str(output_path), str(solution_path), f"--label=your output:({output_path})", f"--label=answer:({solution_path})"]
         diff_exit_code: int
         diff_stdout: bytes
@@ -0,0 +1,53 @@
+//&S-
+//&T-
+//&D-
+
+inlineleaf;
+
+var g: integer;
+
+sum(a, b: integer): integer
+begin
+    return a + b + g;
+end
+end
+
+bump(x: integer)
+begin
+    g := g + x;
+end
+end
+
+square(a: integer): integer
+begin
+    var t: integer;
+    t := a * a;
+    return t;
+end
+end
+
+begin
+
+var a, t: integer;
+var i: integer;
+a := 5;
+t := 7;
+
+bump(3);
+print sum(a, 1);
+print sum(sum(1, 2), a);
+
+for i := 0 to 4 do
+begin
+    bump(i);
+    a := a + square(i + 1);
+end
+end do
+
+// The locals of an inlined callee do not clash with the ones of the caller.
+print a;
+print t;
+print g;
+
+end
+end
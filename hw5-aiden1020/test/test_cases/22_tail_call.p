@@ -0,0 +1,62 @@
+//&S-
+//&T-
+//&D-
+
+tailcall;
+
+var g: integer;
+
+accumulate(n, a: integer): integer
+begin
+    if n = 0 then
+    begin
+        return a;
+    end
+    end if
+    g := g + 1;
+    return accumulate(n - 1, a + 2);
+end
+end
+
+factorial(n: integer): integer
+begin
+    if n <= 1 then
+    begin
+        return 1;
+    end
+    end if
+    return n * factorial(n - 1);
+end
+end
+
+twice(n: integer): integer
+begin
+    var k: integer;
+    k := n * 2;
+    g := g + k;
+    return k;
+end
+end
+
+outer(n: integer): integer
+begin
+    var q: integer;
+    q := n + 1;
+    twice(q);
+    return accumulate(q, 0);
+end
+end
+
+begin
+
+g := 0;
+
+// Deep enough to overflow the stack unless the recursion reuses the frame.
+print accumulate(200000, 0);
+print g;
+print factorial(10);
+print outer(3);
+print g;
+
+end
+end
@@ -0,0 +1,72 @@
+//&S-
+//&T-
+//&D-
+
+commonsubexpressions;
+
+var g: array 4 of integer;
+
+setfirst(p: array 4 of integer; v: integer)
+begin
+    p[0] := v;
+end
+end
+
+// Two returns keep it from being inlined, so `p` aliases `g` at run time.
+aliased(p: array 4 of integer; stop: boolean): integer
+begin
+    var x, y: integer;
+    if stop then
+    begin
+        return 0;
+    end
+    end if
+    x := p[0] + 1;
+    g[0] := 9;
+    y := p[0] + 1;
+    print x;
+    print y;
+    return y;
+end
+end
+
+begin
+
+var a: array 4 of integer;
+var b, c, x, y: integer;
+var r, s, t: real;
+
+b := 3;
+c := 4;
+x := b * c + b * c;
+y := (b * c) - 1;
+print x;
+print y;
+
+// An array passed to a function may be written through the parameter.
+a[0] := 1;
+x := a[0] + 1;
+setfirst(a, 7);
+y := a[0] + 1;
+print x;
+print y;
+
+a[1] := 5;
+x := a[1] * 2;
+read a[1];
+y := a[1] * 2;
+print x;
+print y;
+
+g[0] := 1;
+print aliased(g, false);
+
+// Reals that print alike are still different values.
+r := 1000000.0;
+s := r * 0.0000001;
+t := r * 0.0000002;
+print s;
+print t;
+
+end
+end
@@ -0,0 +1,43 @@
+//&S-
+//&T-
+//&D-
+
+shortcircuit;
+
+var g: integer;
+
+count(n: integer): boolean
+begin
+    g := g + n;
+    return n > 1;
+end
+end
+
+begin
+
+var a, b: integer;
+var x, y, z: boolean;
+
+a := 1;
+b := 2;
+g := 0;
+
+// The right operand is only called if the left one does not decide.
+x := (a < b) and count(1);
+y := (a < b) and count(2);
+z := (a > b) and count(4);
+print x;
+print y;
+print z;
+print g;
+
+x := not (a < b) or count(8);
+y := not (a < b) or count(16);
+z := (a < b) or count(32);
+print x;
+print y;
+print z;
+print g;
+
+end
+end
@@ -0,0 +1,25 @@
+//&S-
+//&T-
+//&D-
+
+functioncache;
+
+// Two returns keep it from being inlined, so its cached code is used.
+scale(x: real): real
+begin
+    if x < 0.0 then
+    begin
+        return 0.0;
+    end
+    end if
+    return 1.0 + x * 0.0000003;
+end
+end
+
+begin
+
+print scale(1000000.0);
+print scale(2000000.0);
+
+end
+end
@@ -0,0 +1,58 @@
+//&S-
+//&T-
+//&D-
+
+checkedmodule;
+
+var n: 4;
+var scale: 0.25;
+var title: "sum";
+var grid: array 4 of integer;
+var total: integer;
+
+weigh(x: integer; w: real): real
+begin
+    return x * w;
+end
+end
+
+fill()
+begin
+    for i := 0 to 4 do
+    begin
+        grid[i] := i * i;
+    end
+    end do
+end
+end
+
+begin
+
+var i: integer;
+var finished: boolean;
+
+fill();
+total := 0;
+i := 0;
+finished := false;
+while not finished do
+begin
+    // Shadows the global constant in the scope of the loop body.
+    var n: 2;
+    total := total + grid[i] * n;
+    i := i + 1;
+    if i >= 4 then
+    begin
+        finished := true;
+    end
+    end if
+end
+end do
+
+print title;
+print total;
+print n;
+print weigh(total, scale);
+
+end
+end
@@ -0,0 +1,25 @@
+//&S-
+//&T-
+//&D-
+
+prelude;
+
+var i: integer;
+
+begin
+
+acc := 0;
+i := 0;
+while i < limit do
+begin
+    acc := acc + i;
+    i := i + 1;
+end
+end do
+grid[1][2] := acc;
+print banner;
+print grid[1][2];
+print ratio * 4;
+
+end
+end
@@ -0,0 +1,17 @@
+//&S-
+//&T-
+//&D-
+
+// The declarations shared by "28_prelude", which is compiled with the
+// module of this program.
+preludedeclarations;
+
+var limit: 10;
+var ratio: 0.5;
+var banner: "total";
+var acc: integer;
+var grid: array 3 of array 3 of integer;
+
+begin
+end
+end
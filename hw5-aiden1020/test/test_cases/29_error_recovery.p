@@ -0,0 +1,46 @@
+//&S-
+//&T-
+//&D-
+
+errorrecovery;
+
+// Each syntax error is recovered at the end of its declaration, function
+// or statement, and the ids declared before it are still in scope.
+var a, b: array of integer;
+var c d: integer;
+var e: integer;
+
+// Both are still declared, without parameters, so that their calls are not
+// reported.
+broken(n: integer;; m: real): integer
+begin
+    return n;
+end
+end
+
+prototype(n integer);
+
+begin
+
+a[1] := 1;
+b := a;
+c := 2;
+e := * 3;
+e := "four";
+if e > then
+begin
+    print c;
+end
+else
+begin
+    // Still checked.
+    print g;
+end
+end if
+e := broken(1, 2.0);
+prototype(3);
+print e + c;
+print f;
+
+end
+end
@@ -0,0 +1,26 @@
+//&S-
+//&T-
+//&D-
+
+diagnosticssarif;
+
+var count: integer;
+var count: real;
+var broken: ;
+
+double(n: integer): integer
+begin
+    return n * 2;
+end
+end
+
+begin
+
+count := double(1, 2);
+count := "one";
+broken := 1;
+print undefined;
+print undefined;
+
+end
+end
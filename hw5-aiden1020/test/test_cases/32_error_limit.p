@@ -0,0 +1,22 @@
+//&S-
+//&T-
+//&D-
+
+errorlimit;
+
+var x: integer;
+
+begin
+
+// Only the first three distinct errors are printed; the repeat of 'a' is
+// counted with it, and the rest are only counted at the end.
+x := a;
+x := b;
+x := a + 1;
+x := c;
+x := d;
+x := e;
+x := "string";
+
+end
+end
@@ -0,0 +1,26 @@
+//&S-
+//&T-
+//&D-
+
+errordedup;
+
+var x: integer;
+var x: real;
+var x: boolean;
+var list: array 2 of integer;
+
+begin
+
+// A lookup error that repeats the kind and the symbol of an earlier one is
+// printed once with the locations of the repeats; any other error is printed
+// on its own.
+x := missing;
+x := missing + 1;
+print missing;
+missing := 3;
+x := list[1][1];
+x := list[2][2];
+x := other;
+
+end
+end
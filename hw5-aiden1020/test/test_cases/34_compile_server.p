@@ -0,0 +1,27 @@
+//&S-
+//&T-
+//&D-
+
+compileserver;
+
+var greeting: "served";
+
+square(n: integer): integer
+begin
+    return n * n;
+end
+end
+
+begin
+
+var i: integer;
+
+print greeting;
+for i := 1 to 4 do
+begin
+    print square(i);
+end
+end do
+
+end
+end
@@ -0,0 +1,19 @@
+//&S-
+//&T-
+//&D-
+
+errorlimitsarif;
+
+var x: integer;
+
+begin
+
+// The number of errors over the limit is reported in the SARIF output as
+// well, as a note with the id 'error-limit'.
+x := a;
+x := b;
+x := c;
+x := "string";
+
+end
+end
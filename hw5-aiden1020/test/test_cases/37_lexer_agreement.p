@@ -0,0 +1,34 @@
+//&S+
+//&T+
+//&D-
+/****/
+/* The hand-written lexer is checked against flex on every case in this
+ * directory; this one lists its own source and tokens, and ends without a
+ * newline. **/
+/**********************************************************************/
+lexeragreement;
+
+var count: integer; /* trailing **/
+var ratio: real;
+var name: string;
+var mask: 0777;
+
+/***
+ * A banner ***/
+begin
+    count := 10 mod 3 * 2; /**/
+    ratio := 1.5E2 / 0.25;
+    name := "say ""hi""";
+    if count <> 0 and not (count >= 3) then
+    begin
+        print count;
+    end
+    else
+    begin
+        print mask;
+    end
+    end if
+    print ratio; // comment
+    print name;
+end
+end
\ No newline at end of file
@@ -0,0 +1,19 @@
+//&S-
+//&T-
+//&D-
+
+separatecompilation;
+
+var local: integer;
+
+// The globals and functions come from the interface of the library unit; its
+// code is linked with this one.
+begin
+    total := 5;
+    local := bump(3);
+    print local;
+    print bump(base);
+    print total;
+    print scale(1.5);
+end
+end
@@ -0,0 +1,27 @@
+//&S-
+//&T-
+//&D-
+
+separatelibrary;
+
+var total: integer;
+var base: 10;
+
+// Every function of a unit compiled by "--no-main" is kept, even the ones
+// that nothing in the unit calls.
+bump(step: integer): integer
+begin
+    total := total + step;
+    return total;
+end
+end
+
+scale(x: real): real
+begin
+    return x * 2.5;
+end
+end
+
+begin
+end
+end
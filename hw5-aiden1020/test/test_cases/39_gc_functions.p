@@ -0,0 +1,43 @@
+//&S-
+//&T-
+//&D-
+
+gcfunctions;
+
+// Nothing calls it, so it is dropped.
+unused(n: integer): integer
+begin
+    return n * 3;
+end
+end
+
+// A leaf inlined at its only call, which needs no copy of its own.
+increment(n: integer): integer
+begin
+    return n + 1;
+end
+end
+
+// Reached only by the tail call in 'relay', which jumps to it instead of
+// calling it.
+sum(n, a: integer): integer
+begin
+    if n = 0 then
+    begin
+        return a;
+    end
+    end if
+    return sum(n - 1, a + n);
+end
+end
+
+relay(n: integer): integer
+begin
+    return sum(increment(n), 0);
+end
+end
+
+begin
+    print relay(3);
+end
+end
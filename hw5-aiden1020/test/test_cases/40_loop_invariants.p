@@ -0,0 +1,50 @@
+//&S-
+//&T-
+//&D-
+
+loopinvariant;
+
+var g: integer;
+var greeting: string;
+
+bump(n: integer): integer
+begin
+    g := g + n;
+    return g;
+end
+end
+
+begin
+
+var i, k: integer;
+var name, line: string;
+g := 1;
+greeting := "hello ";
+name := "world";
+
+// The loop runs zero times, so nothing hoisted out of it may show.
+k := 0;
+while k > 0 do
+begin
+    line := greeting + name;
+    print line;
+    print g * 10;
+    k := bump(1);
+end
+end do
+print g;
+
+// 'greeting + name' is invariant, but 'g * 10' is not: the call to 'bump'
+// in the loop modifies the global.
+for i := 1 to 3 do
+begin
+    line := greeting + name;
+    print line;
+    print g * 10;
+    k := bump(i);
+end
+end do
+print g;
+
+end
+end